@@ -0,0 +1,77 @@
+/*
+
+  EventQueue.cpp
+
+  Copyright (c) 2024, Dan Mowehhuk (danmowehhuk@gmail.com)
+  All rights reserved.
+
+*/
+
+#include "EventQueue.h"
+#include "hal/EventuinoHal.h"
+
+using namespace eventuino;
+
+uint16_t EventQueue::_eventTimestampMs = 0;
+
+EventQueue::EventQueue(uint8_t capacity, uint8_t dispatchLimit):
+    _events(new QueuedEvent[capacity]), _capacity(capacity),
+    _dispatchLimit(dispatchLimit) {};
+
+EventQueue::~EventQueue() {
+  delete[] _events;
+  _events = nullptr;
+}
+
+bool EventQueue::post(const EventDelegate& callback,
+    uint8_t value, uint8_t kind, void*) {
+  if (!callback) return false;
+  uint8_t priority = priorityOf ? priorityOf(value, kind) : 0;
+  if (priority > 15) priority = 15;
+  uint16_t now = EventuinoHal::millis();
+
+  uint8_t saved = EventuinoHal::enterCritical();
+  bool queued = _size < _capacity;
+  if (queued) {
+    QueuedEvent& e = _events[_size];
+    e.callback = callback;
+    e.timestampMs = now;
+    e.value = value;
+    e.kind = (priority << 4) | (kind & 0x0F);
+    _size = _size + 1;
+  } else if (_overflowCount < 0xFFFF) {
+    _overflowCount++;
+  }
+  EventuinoHal::exitCritical(saved);
+  return queued;
+}
+
+uint8_t EventQueue::dispatch(void* state, uint32_t budgetMicros) {
+  unsigned long start = EventuinoHal::micros();
+  uint8_t dispatched = 0;
+  while ((_dispatchLimit == 0 || dispatched < _dispatchLimit) &&
+      (uint32_t)(EventuinoHal::micros() - start) < budgetMicros) {
+    uint8_t saved = EventuinoHal::enterCritical();
+    if (_size == 0) {
+      EventuinoHal::exitCritical(saved);
+      break;
+    }
+    // The earliest event of the highest priority
+    uint8_t next = 0;
+    for (uint8_t i = 1; i < _size; i++) {
+      if ((_events[i].kind >> 4) < (_events[next].kind >> 4)) next = i;
+    }
+    QueuedEvent e = _events[next];
+    for (uint8_t i = next + 1; i < _size; i++) {
+      _events[i - 1] = _events[i];
+    }
+    _size = _size - 1;
+    EventuinoHal::exitCritical(saved);
+
+    // Invoke the handler outside the critical section
+    _eventTimestampMs = e.timestampMs;
+    e.callback(e.value, state);
+    dispatched++;
+  }
+  return _size;
+}
@@ -0,0 +1,120 @@
+/*
+
+  eventuino::EventQueue.h
+
+  An optional, bounded queue of events for Eventuino. While installed
+  with Eventuino::setEventQueue(...), sources no longer invoke their
+  callbacks from inside their own poll(). Instead each event is queued
+  as a compact record, and once every source has been polled, Eventuino
+  dispatches the queued events in priority order, at most dispatchLimit
+  per poll(). A slow handler then delays only the handlers behind it,
+  never the detection of other sources.
+
+  Events can also be posted from interrupt handlers with post(...), on
+  AVR, Cortex-M and Linux (see EventuinoHal::enterCritical()).
+
+  Uses 8 bytes per queued event, plus 11 bytes.
+
+  Copyright (c) 2024, Dan Mowehhuk (danmowehhuk@gmail.com)
+  All rights reserved.
+
+*/
+
+#ifndef eventuino_EventQueue_h
+#define eventuino_EventQueue_h
+
+#include "EventSource.h"
+#include <stdint.h>
+
+namespace eventuino {
+
+  class EventQueue: public EventSink {
+
+    public:
+      /*
+       * capacity      - Most events the queue can hold
+       * dispatchLimit - Most events dispatched per Eventuino::poll(), or
+       *                 0 for no limit
+       */
+      EventQueue(uint8_t capacity, uint8_t dispatchLimit = 0);
+      ~EventQueue();
+
+      /*
+       * Decides an event's priority from its value and kind; 0 is the
+       * highest and 15 the lowest. Events of equal priority are
+       * dispatched in the order they arrived. Without one, every event
+       * has priority 0.
+       */
+      typedef uint8_t (*priorityCallback_t)(uint8_t value, uint8_t kind);
+      priorityCallback_t priorityOf = 0;
+
+      /*
+       * Queues an event to invoke callback(value, state) on a later
+       * dispatch, where state is the one passed to that poll(). Safe to
+       * call from an interrupt handler where critical sections nest.
+       * Returns false without queueing if the queue is full or callback
+       * is 0; sources then invoke the callback right away instead, so no
+       * input event is lost.
+       */
+      bool post(const EventDelegate& callback, uint8_t value,
+          uint8_t kind, void* state = nullptr) override;
+      bool post(EventSource::eventuinoCallback_t callback, uint8_t value,
+          uint8_t kind, void* state = nullptr) {
+        return post(EventDelegate(callback), value, kind, state);
+      }
+
+      /*
+       * Dispatches queued events, highest priority first, up to the
+       * dispatch limit or until budgetMicros has passed. Returns how
+       * many events are still queued. Called by Eventuino::poll(); not
+       * usually needed directly.
+       */
+      uint8_t dispatch(void* state = nullptr, uint32_t budgetMicros = 0xFFFFFFFF);
+
+      uint8_t size() {
+        return _size;
+      }
+
+      // Events that found the queue full
+      uint16_t overflowCount() {
+        return _overflowCount;
+      }
+
+      /*
+       * Within a callback being dispatched, the truncated
+       * EventuinoHal::millis() at which its event was queued
+       */
+      static uint16_t eventTimestampMs() {
+        return _eventTimestampMs;
+      }
+
+      // Disable moving and copying
+      EventQueue(EventQueue&& other) = delete;
+      EventQueue& operator=(EventQueue&& other) = delete;
+      EventQueue(const EventQueue&) = delete;
+      EventQueue& operator=(const EventQueue&) = delete;
+
+    private:
+      EventQueue() = delete;
+
+      struct QueuedEvent {
+        EventDelegate callback;
+        uint16_t timestampMs;
+        uint8_t value;
+        uint8_t kind;  // bits: priority (4) | kind (4)
+      };
+
+      // Queued events in arrival order; dispatched ones are removed
+      QueuedEvent* _events;
+      uint8_t _capacity;
+      uint8_t _dispatchLimit;
+      volatile uint8_t _size = 0;
+      uint16_t _overflowCount = 0;
+
+      static uint16_t _eventTimestampMs;
+
+  };
+
+}
+
+#endif
@@ -0,0 +1,41 @@
+/*
+
+  EventSource.cpp
+
+  Copyright (c) 2024, Dan Mowehhuk (danmowehhuk@gmail.com)
+  All rights reserved.
+
+*/
+
+#include "EventSource.h"
+#include <stdint.h>
+
+using namespace eventuino;
+
+const EventRoutingTable* EventSource::_routingTable = nullptr;
+#if defined(NO_ARDUINO) && defined(HAL_LINUX)
+thread_local EventSink* EventSource::_eventSink = nullptr;
+#else
+EventSink* EventSource::_eventSink = nullptr;
+#endif
+
+static EventSource::eventuinoCallback_t _eventuinoRoute(
+    const EventRoutingTable* table, uint8_t value, uint8_t kind) {
+  if (!table) return 0;
+  uint8_t row = value - table->firstValue;
+  if (row >= table->valueCount || kind >= table->kindCount) return 0;
+  return table->handlers[row * table->kindCount + kind];
+}
+
+void EventSource::emit(const EventDelegate& callback, uint8_t value, 
+    uint8_t kind, void* state) {
+  EventDelegate handler = callback;
+  if (!handler) handler = _eventuinoRoute(_routingTable, value, kind);
+  if (!handler) return;
+  if (_eventSink && _eventSink->post(handler, value, kind, state)) return;
+  handler(value, state);
+}
+
+bool EventSource::isRouted(uint8_t value, uint8_t kind) {
+  return _eventuinoRoute(_routingTable, value, kind) != 0;
+}
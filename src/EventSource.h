@@ -16,6 +16,10 @@
 
 namespace eventuino {
 
+  struct EventRoutingTable;
+  class EventSink;
+  class EventDelegate;
+
   class EventSource {
 
     public:
@@ -34,6 +38,59 @@ namespace eventuino {
        */
       virtual void poll(void* state = nullptr) = 0;
 
+      /*
+       * How many milliseconds this source can safely go without being
+       * polled, unless a pin edge arrives first. 0 (the default) means
+       * it should be polled again as soon as possible, and 0xFFFF that
+       * it is waiting on nothing but an edge.
+       */
+      virtual uint16_t idleMs() { return 0; }
+
+      /*
+       * Seeded begin() support (see Eventuino::BEGIN_SEEDED). A source
+       * whose setup() does nothing but set one pin to INPUT_PULLUP
+       * returns it from inputPullupPin(), so Eventuino can set all such
+       * pins in batched port writes instead of calling setup(). Once the
+       * pins have settled, seedState(...) takes the source's state from
+       * a single reading rather than a debounce delay later, calling its
+       * change callbacks once if notify is set.
+       */
+      static const uint8_t NO_PIN = 0xFF;
+      virtual uint8_t inputPullupPin() { return NO_PIN; }
+      virtual void seedState(bool, void*) {}
+
+      /*
+       * Warm restart support (see Eventuino::saveState(...)). saveState
+       * writes up to snapshotMax() bytes of the source's runtime state to
+       * the buffer and returns how many. Sources that hold others, such
+       * as a DigitalPinGroup, can raise it from SNAPSHOT_MAX to 255.
+       * restoreState is given them back after setup(), following a reset,
+       * and should ignore a length it doesn't expect. Times are saved
+       * relative to the moment of saving. By default nothing is saved,
+       * and the source starts afresh.
+       *
+       * snapshotLayout identifies what saveState writes, and is saved
+       * with it, so that a snapshot taken before the sources were
+       * reordered (e.g. by a firmware update) is rejected rather than
+       * restoring one source's state into another. Sources of the same
+       * layout can't be told apart.
+       */
+      static const uint8_t SNAPSHOT_MAX = 8;
+      enum : uint8_t {
+        SNAPSHOT_NONE = 0,
+        SNAPSHOT_DIGITAL_PIN,
+        SNAPSHOT_TIMER_14BIT,
+        SNAPSHOT_TIMER_30BIT,
+        SNAPSHOT_INTERVAL_TIMER_14BIT,
+        SNAPSHOT_INTERVAL_TIMER_30BIT,
+        SNAPSHOT_DIGITAL_PIN_GROUP,
+        SNAPSHOT_POSITION_SELECTOR
+      };
+      virtual uint8_t snapshotMax() { return SNAPSHOT_MAX; }
+      virtual uint8_t snapshotLayout() { return SNAPSHOT_NONE; }
+      virtual uint8_t saveState(uint8_t*) { return 0; }
+      virtual void restoreState(const uint8_t*, uint8_t) {}
+
       /*
        * Event callback functions must use this signature, where the
        * "value" is specified in the constructor of the sub-class
@@ -42,6 +99,195 @@ namespace eventuino {
        */
       typedef void (*eventuinoCallback_t)(uint8_t value, void* state);
 
+      /*
+       * The kinds of events a source can emit. These index the columns
+       * of an EventRoutingTable.
+       */
+      enum eventKind_t : uint8_t {
+        KIND_CHANGE = 0,   // onChangeState, onFlip
+        KIND_ACTIVATE,     // onPressed, onActivate
+        KIND_DEACTIVATE,   // onReleased, onDeactivate
+        KIND_LONG_HOLD,    // onLongPress
+        KIND_EXPIRE,       // onExpire
+        KIND_COUNT
+      };
+
+    protected:
+      /*
+       * Invoke the source's own callback if it has one, otherwise look
+       * up a handler for (value, kind) in the Eventuino routing table.
+       * If an EventSink is installed, it may take the event to invoke
+       * the handler later instead.
+       */
+      static void emit(const EventDelegate& callback, uint8_t value, 
+          uint8_t kind, void* state);
+
+      // True if the routing table has a handler for (value, kind)
+      static bool isRouted(uint8_t value, uint8_t kind);
+
+    private:
+      static const EventRoutingTable* _routingTable;
+      // Where emit() posts events instead of invoking them. An Eventuino
+      // installs its own sink only while polling its sources; on Linux
+      // each thread has its own, so ThreadedEventuino's detection thread
+      // doesn't capture events from sources polled elsewhere.
+#if defined(NO_ARDUINO) && defined(HAL_LINUX)
+      static thread_local EventSink* _eventSink;
+#else
+      static EventSink* _eventSink;
+#endif
+
+      friend class Eventuino;
+      friend class ThreadedEventuino;
+
+  };
+
+  /*
+   * Receives events emitted while it is installed, so their handlers can
+   * be invoked somewhere other than inside the source's poll(); e.g. on
+   * another thread. post() returns false to have the handler invoked
+   * immediately as usual.
+   */
+  class EventSink {
+
+    public:
+      virtual bool post(const EventDelegate& callback, 
+          uint8_t value, uint8_t kind, void* state) = 0;
+
+  };
+
+  /*
+   * The type of the standard callbacks (onPressed, onFlip, onExpire, ...).
+   * Besides a plain eventuinoCallback_t, it can hold an object and a
+   * function to call on it, so handlers can carry their own context
+   * instead of casting the state shared by every source:
+   *
+   *   // A member function void Led::toggle(uint8_t value, void* state)
+   *   button.onPressed = EventDelegate::bind<Led, &Led::toggle>(&led);
+   *
+   *   // A stateless lambda or function taking the context first
+   *   button.onPressed = EventDelegate::bind(&led,
+   *       [](Led* led, uint8_t value, void* state) { led->toggle(); });
+   *
+   * Either way it's two pointers, with no heap and no std::function.
+   */
+  class EventDelegate {
+
+    private:
+      // A lambda's type is unique to its expression, so the function
+      // it converts to can be kept once per type. Plain function
+      // pointers share a type and are excluded (bind them with the
+      // template parameter overload below instead).
+      template<class T, class Lambda>
+      struct LambdaHolder {
+        typedef void (*function_t)(T*, uint8_t, void*);
+        static function_t function;
+      };
+      template<class T, class R, class... Args>
+      struct LambdaHolder<T, R (*)(Args...)> {};
+
+    public:
+      EventDelegate(): _stub(nullptr) {
+        _target.function = nullptr;
+      }
+
+      EventDelegate(EventSource::eventuinoCallback_t function): _stub(nullptr) {
+        _target.function = function;
+      }
+
+      EventDelegate& operator=(EventSource::eventuinoCallback_t function) {
+        _target.function = function;
+        _stub = nullptr;
+        return *this;
+      }
+
+      // Binds a member function of object
+      template<class T, void (T::*Method)(uint8_t, void*)>
+      static EventDelegate bind(T* object) {
+        EventDelegate d;
+        d._target.object = object;
+        d._stub = &invokeMember<T, Method>;
+        return d;
+      }
+
+      // Binds a function taking context as its first argument
+      template<class T, void (*Function)(T*, uint8_t, void*)>
+      static EventDelegate bind(T* context) {
+        EventDelegate d;
+        d._target.object = context;
+        d._stub = &invokeFunction<T, Function>;
+        return d;
+      }
+
+      // Binds a stateless (capture-less) lambda taking context as its
+      // first argument
+      template<class T, class Lambda>
+      static EventDelegate bind(T* context, Lambda lambda,
+          typename LambdaHolder<T, Lambda>::function_t = 0) {
+        LambdaHolder<T, Lambda>::function = lambda;
+        EventDelegate d;
+        d._target.object = context;
+        d._stub = &invokeLambda<T, Lambda>;
+        return d;
+      }
+
+      void operator()(uint8_t value, void* state) const {
+        if (_stub) {
+          _stub(_target.object, value, state);
+        } else {
+          _target.function(value, state);
+        }
+      }
+
+      explicit operator bool() const {
+        return _stub != nullptr || _target.function != nullptr;
+      }
+
+    private:
+      typedef void (*stub_t)(void* target, uint8_t value, void* state);
+
+      template<class T, void (T::*Method)(uint8_t, void*)>
+      static void invokeMember(void* object, uint8_t value, void* state) {
+        (static_cast<T*>(object)->*Method)(value, state);
+      }
+
+      template<class T, void (*Function)(T*, uint8_t, void*)>
+      static void invokeFunction(void* context, uint8_t value, void* state) {
+        Function(static_cast<T*>(context), value, state);
+      }
+
+      template<class T, class Lambda>
+      static void invokeLambda(void* context, uint8_t value, void* state) {
+        LambdaHolder<T, Lambda>::function(static_cast<T*>(context), value, state);
+      }
+
+      union {
+        void* object;
+        EventSource::eventuinoCallback_t function;
+      } _target;
+      stub_t _stub;
+
+  };
+
+  template<class T, class Lambda>
+  typename EventDelegate::LambdaHolder<T, Lambda>::function_t
+      EventDelegate::LambdaHolder<T, Lambda>::function = nullptr;
+
+  /*
+   * A dense jump table of handlers shared by all event sources, keyed by
+   * (value, kind). Row r holds the handlers for value (firstValue + r),
+   * and column k the handler for event kind k. Unused entries are 0.
+   *
+   * Sources only consult the table for events they have no callback of
+   * their own for, so a plain DigitalPinSource with no callbacks set can
+   * stand in for a Button or Toggle without carrying any callback
+   * pointers. Swapping the table rebinds every routed source at once.
+   */
+  struct EventRoutingTable {
+    uint8_t firstValue;
+    uint8_t valueCount;
+    uint8_t kindCount;  // columns per row, at most KIND_COUNT
+    const EventSource::eventuinoCallback_t* handlers; // valueCount * kindCount
   };
 
 }
@@ -23,6 +23,9 @@ void Eventuino::setEventSources(EventSource* *srcs, uint8_t n) {
   _eventSources = nullptr;
   _eventSources = srcs;
   _eventSourceCount = n;
+  _pollCursor = 0;
+  if (_schedule) delete[] _schedule;
+  _schedule = nullptr;
 }
 
 void Eventuino::addEventSource(EventSource* eventSource) {
@@ -34,6 +37,16 @@ void Eventuino::addEventSource(EventSource* eventSource) {
 
   delete[] _eventSources;
   _eventSources = newEvtSources;
+
+  if (_schedule) {
+    PollSchedule* newSchedule = new PollSchedule[_eventSourceCount + 1];
+    for (uint8_t i = 0; i < _eventSourceCount; i++) {
+      newSchedule[i] = _schedule[i];
+    }
+    newSchedule[_eventSourceCount] = { 1, 0 };
+    delete[] _schedule;
+    _schedule = newSchedule;
+  }
   _eventSourceCount++;
 }
 
@@ -44,13 +57,211 @@ void Eventuino::begin() {
   }	
 }
 
+void Eventuino::begin(beginMode_t mode, uint16_t settleMicros, void* state) {
+  uint8_t* pins = new uint8_t[_eventSourceCount > 0 ? _eventSourceCount : 1];
+  uint8_t pinCount = 0;
+  for (uint8_t i = 0; i < _eventSourceCount; i++) {
+    EventSource* es = _eventSources[i];
+    uint8_t pin = es->inputPullupPin();
+    if (pin == EventSource::NO_PIN) {
+      es->setup();
+    } else {
+      pins[pinCount++] = pin;
+    }
+  }
+  EventuinoHal::pinModeInputPullups(pins, pinCount);
+  delete[] pins;
+
+  EventuinoHal::delayMicros(settleMicros);
+  EventSink* previous = EventSource::_eventSink;
+  EventSource::_eventSink = _sink;
+  for (uint8_t i = 0; i < _eventSourceCount; i++) {
+    _eventSources[i]->seedState(mode == BEGIN_SEEDED_NOTIFY, state);
+  }
+  EventSource::_eventSink = previous;
+}
+
 void Eventuino::poll(void* state) {
+  // Route only this instance's events to its sink (another Eventuino
+  // may be polling from within a callback, or have its own queue)
+  EventSink* previous = EventSource::_eventSink;
+  EventSource::_eventSink = _sink;
   for (uint8_t i = 0; i < _eventSourceCount; i++) {
+    pollSource(i, state);
+  }
+  EventSource::_eventSink = previous;
+  if (_eventQueue) _eventQueue->dispatch(state);
+}
+
+uint8_t Eventuino::poll(uint32_t budgetMicros, void* state) {
+  if (_eventSourceCount == 0) return 0;
+  unsigned long start = EventuinoHal::micros();
+  uint8_t polled = 0;
+  EventSink* previous = EventSource::_eventSink;
+  EventSource::_eventSink = _sink;
+  do {
+    pollSource(_pollCursor, state);
+    if (++_pollCursor >= _eventSourceCount) _pollCursor = 0;
+    polled++;
+  } while (polled < _eventSourceCount &&
+      (uint32_t)(EventuinoHal::micros() - start) < budgetMicros);
+  EventSource::_eventSink = previous;
+  if (_eventQueue) {
+    uint32_t elapsed = EventuinoHal::micros() - start;
+    if (elapsed < budgetMicros) _eventQueue->dispatch(state, budgetMicros - elapsed);
+  }
+  return _eventSourceCount - polled;
+}
+
+void Eventuino::pollSource(uint8_t index, void* state) {
+  if (_schedule) {
+    PollSchedule& ps = _schedule[index];
+    if (ps.period & 0x8000) {
+      uint16_t now = EventuinoHal::millis();
+      if ((uint16_t)(now - ps.mark) < (ps.period & 0x7FFF)) return;
+      ps.mark = now;
+    } else if (ps.mark > 0) {
+      ps.mark--;
+      return;
+    } else {
+      ps.mark = ps.period - 1;
+    }
+  }
+  EventSource* es = _eventSources[index];
+  if (es) {
+    es->poll(state);
+  } else {
+    EventuinoHal::println("ES is nullptr");
+  }
+}
+
+int16_t Eventuino::indexOf(EventSource* eventSource) {
+  for (uint8_t i = 0; i < _eventSourceCount; i++) {
+    if (_eventSources[i] == eventSource) return i;
+  }
+  return -1;
+}
+
+void Eventuino::setSchedule(uint8_t index, uint16_t period, uint16_t mark) {
+  if (!_schedule) {
+    _schedule = new PollSchedule[_eventSourceCount];
+    for (uint8_t i = 0; i < _eventSourceCount; i++) {
+      _schedule[i] = { 1, 0 };
+    }
+  }
+  _schedule[index] = { period, mark };
+}
+
+bool Eventuino::setPollDivisor(EventSource* eventSource, uint8_t divisor) {
+  int16_t index = indexOf(eventSource);
+  if (index < 0) return false;
+  if (divisor == 0) divisor = 1;
+  // Stagger by position, so sources sharing a divisor take turns
+  setSchedule(index, divisor, index % divisor);
+  return true;
+}
+
+bool Eventuino::setPollIntervalMs(EventSource* eventSource, uint16_t intervalMs) {
+  int16_t index = indexOf(eventSource);
+  if (index < 0) return false;
+  if (intervalMs > 0x7FFF) intervalMs = 0x7FFF;
+  // Due right away on the next poll()
+  setSchedule(index, 0x8000 | intervalMs,
+      (uint16_t)(EventuinoHal::millis() - intervalMs));
+  return true;
+}
+
+uint16_t Eventuino::idleMs() {
+  if (_eventQueue && _eventQueue->size() > 0) return 0;
+  uint16_t idle = 0xFFFF;
+  for (uint8_t i = 0; i < _eventSourceCount && idle > 0; i++) {
     EventSource* es = _eventSources[i];
     if (es) {
-      es->poll(state);
-    } else {
-      EventuinoHal::println("ES is nullptr");
+      uint16_t esIdle = es->idleMs();
+      if (esIdle < idle) idle = esIdle;
+    }
+  }
+  return idle;
+}
+
+void Eventuino::waitForEvents() {
+  uint16_t idle = idleMs();
+  if (idle > 0) EventuinoHal::waitForEdge(idle);
+}
+
+// Snapshot layout: magic, version, source count, then each source's
+// layout, length and state, then a Fletcher-16 checksum of everything
+// before it
+static const uint8_t _eventuinoSnapshotMagic = 0xE7;
+static const uint8_t _eventuinoSnapshotVersion = 2;
+static const uint8_t _eventuinoSnapshotHeader = 3;
+
+static uint16_t _eventuinoFletcher16(const uint8_t* data, uint16_t length) {
+  uint16_t sum1 = 0;
+  uint16_t sum2 = 0;
+  for (uint16_t i = 0; i < length; i++) {
+    sum1 = (sum1 + data[i]) % 255;
+    sum2 = (sum2 + sum1) % 255;
+  }
+  return (sum2 << 8) | sum1;
+}
+
+uint16_t Eventuino::snapshotSize() {
+  uint16_t size = _eventuinoSnapshotHeader + 2;
+  for (uint8_t i = 0; i < _eventSourceCount; i++) {
+    EventSource* es = _eventSources[i];
+    size += 2 + (es ? es->snapshotMax() : 0);
+  }
+  return size;
+}
+
+uint16_t Eventuino::saveState(uint8_t* buffer, uint16_t capacity) {
+  if (capacity < snapshotSize()) return 0;
+  buffer[0] = _eventuinoSnapshotMagic;
+  buffer[1] = _eventuinoSnapshotVersion;
+  buffer[2] = _eventSourceCount;
+  uint16_t length = _eventuinoSnapshotHeader;
+  for (uint8_t i = 0; i < _eventSourceCount; i++) {
+    EventSource* es = _eventSources[i];
+    uint8_t saved = es ? es->saveState(buffer + length + 2) : 0;
+    buffer[length] = es ? es->snapshotLayout() : EventSource::SNAPSHOT_NONE;
+    buffer[length + 1] = saved;
+    length += 2 + saved;
+  }
+  uint16_t checksum = _eventuinoFletcher16(buffer, length);
+  buffer[length++] = checksum & 0xFF;
+  buffer[length++] = checksum >> 8;
+  return length;
+}
+
+bool Eventuino::restoreState(const uint8_t* buffer, uint16_t length) {
+  if (length < _eventuinoSnapshotHeader + 2 ||
+      buffer[0] != _eventuinoSnapshotMagic ||
+      buffer[1] != _eventuinoSnapshotVersion ||
+      buffer[2] != _eventSourceCount) {
+    return false;
+  }
+  // Walk the lengths before trusting them to find the checksum, and
+  // check each entry was saved by a source of the same layout
+  uint16_t end = _eventuinoSnapshotHeader;
+  for (uint8_t i = 0; i < _eventSourceCount; i++) {
+    EventSource* es = _eventSources[i];
+    uint8_t layout = es ? es->snapshotLayout() : EventSource::SNAPSHOT_NONE;
+    if (end + 1 >= length - 2 || buffer[end] != layout ||
+        buffer[end + 1] > (es ? es->snapshotMax() : 0)) {
+      return false;
     }
+    end += 2 + buffer[end + 1];
+  }
+  if (end > length - 2) return false;
+  uint16_t checksum = buffer[end] | ((uint16_t)buffer[end + 1] << 8);
+  if (checksum != _eventuinoFletcher16(buffer, end)) return false;
+
+  uint16_t offset = _eventuinoSnapshotHeader;
+  for (uint8_t i = 0; i < _eventSourceCount; i++) {
+    EventSource* es = _eventSources[i];
+    if (es) es->restoreState(buffer + offset + 2, buffer[offset + 1]);
+    offset += 2 + buffer[offset + 1];
   }
+  return true;
 }
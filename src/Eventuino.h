@@ -14,8 +14,24 @@
 #define Eventuino_h
 
 #include "EventSource.h"
+#include "EventQueue.h"
 #include <stdint.h>
 
+/*
+ * Places a snapshot buffer in RAM that isn't cleared on reset, where
+ * supported (AVR), e.g.
+ *
+ *   uint8_t snapshot[64] EVENTUINO_NOINIT;
+ *
+ * Elsewhere the buffer is zeroed as usual, fails to restore, and the
+ * sources start afresh.
+ */
+#if defined(__AVR__)
+#define EVENTUINO_NOINIT __attribute__((section(".noinit")))
+#else
+#define EVENTUINO_NOINIT
+#endif
+
 using namespace eventuino;
 
 namespace eventuino {
@@ -31,14 +47,38 @@ namespace eventuino {
 
       EventSource* *_eventSources = nullptr;
       uint8_t _eventSourceCount = 0;
+      uint8_t _pollCursor = 0;
+
+      // Per-source poll schedule, parallel to _eventSources and only
+      // allocated once a source is given a poll rate. period is a cycle
+      // divisor, or a ms interval when bit 15 is set. mark counts down
+      // the cycles to the next poll, or holds the last poll time (ms).
+      struct PollSchedule {
+        uint16_t period;
+        uint16_t mark;
+      };
+      PollSchedule* _schedule = nullptr;
+
+      int16_t indexOf(EventSource* eventSource);
+      void setSchedule(uint8_t index, uint16_t period, uint16_t mark);
+      void pollSource(uint8_t index, void* state);
 
       friend class EventuinoTestHelper;
 
+    protected:
+      EventQueue* _eventQueue = nullptr;
+
+      // Where this instance's sources post their events, installed as
+      // EventSource's sink only while it polls them
+      EventSink* _sink = nullptr;
+
     public:
       Eventuino() {};
       ~Eventuino() {
         if (_eventSources) delete[] _eventSources;
         _eventSources = nullptr;
+        if (_schedule) delete[] _schedule;
+        _schedule = nullptr;
         _eventSourceCount = 0;
       };
 
@@ -52,14 +92,137 @@ namespace eventuino {
        */
       void begin();
 
+      /*
+       * Faster begin() that learns every input's state up front:
+       *
+       * BEGIN_SEEDED        - Set the pull-ups of all sources that need
+       *                       nothing else in batched port writes (where
+       *                       the HAL supports it), calling setup() on the
+       *                       rest, wait settleMicros for the inputs to
+       *                       charge, then take each source's state from a
+       *                       single reading, without events. A toggle
+       *                       already on at power-up reads as on right
+       *                       away, instead of reporting an activate a
+       *                       debounce delay later.
+       * BEGIN_SEEDED_NOTIFY - As BEGIN_SEEDED, then invoke each source's
+       *                       change callbacks once with its initial state
+       *                       (e.g. onActivate or onDeactivate, then
+       *                       onFlip), passing them state
+       */
+      enum beginMode_t : uint8_t {
+        BEGIN_SEEDED = 1,
+        BEGIN_SEEDED_NOTIFY
+      };
+      void begin(beginMode_t mode, uint16_t settleMicros = 100, void* state = nullptr);
+
       /*
        * Calls poll() on all the EventSources. This can be called from the Arduino loop()
        * function, or in an interrupt function. The optional state argument optionally
        * enables a state object to be passed to handler functions that would not otherwise
-       * have access to state outside their scope.
+       * have access to state outside their scope. With an EventQueue set, the queued
+       * events are dispatched once all the sources have been polled.
        */
       void poll(void* state = nullptr);
 
+      /*
+       * Time-budgeted poll(). Polls the EventSources round-robin, starting
+       * where the previous budgeted call stopped, until budgetMicros has
+       * passed, then returns how many sources were deferred to the next
+       * call (0 once every source has been polled). At least one source is
+       * polled per call, and a source's poll() - including its callbacks -
+       * is never interrupted, so the budget can be overrun by at most one
+       * poll. Queued events are dispatched while budget remains.
+       */
+      uint8_t poll(uint32_t budgetMicros, void* state);
+
+      /*
+       * Priority classes, as poll divisors for setPollDivisor(...)
+       *
+       * PRIORITY_REALTIME   - Polled on every cycle (default)
+       * PRIORITY_NORMAL     - Polled on every 4th cycle
+       * PRIORITY_BACKGROUND - Polled on every 32nd cycle; e.g. long timers
+       *                       and rarely changed configuration switches
+       */
+      static const uint8_t PRIORITY_REALTIME = 1;
+      static const uint8_t PRIORITY_NORMAL = 4;
+      static const uint8_t PRIORITY_BACKGROUND = 32;
+
+      /*
+       * Poll a source only on every Nth call to poll(). Sources sharing a
+       * divisor are staggered across the cycles rather than all polled on
+       * the same one. A divisor of 1 polls on every cycle again. Returns
+       * false if the source hasn't been added.
+       */
+      bool setPollDivisor(EventSource* eventSource, uint8_t divisor);
+
+      /*
+       * Poll a source at most once every intervalMs (up to 32767), however
+       * often poll() is called. Returns false if the source hasn't been
+       * added.
+       */
+      bool setPollIntervalMs(EventSource* eventSource, uint16_t intervalMs);
+
+      /*
+       * The shortest idleMs() of all the EventSources; i.e. how long the
+       * loop can sleep before the next poll() unless a pin edge arrives.
+       */
+      uint16_t idleMs();
+
+      /*
+       * Blocks until a pin edge arrives or idleMs() passes, where the HAL
+       * supports edge events (-DHAL_LINUX), so a loop of poll() and 
+       * waitForEvents() does not spin. Returns immediately otherwise.
+       */
+      void waitForEvents();
+
+      /*
+       * Set the routing table used to look up handlers for events whose
+       * source has no callback of its own (see EventRoutingTable). Pass
+       * nullptr to disable routing. The table is not copied and must
+       * outlive its use; it can be swapped at any time, taking effect
+       * with the next event.
+       */
+      void setRoutingTable(const EventRoutingTable* table) {
+        EventSource::_routingTable = table;
+      }
+
+      /*
+       * Queue events instead of invoking their callbacks inside each
+       * source's poll(). poll() then polls every source first, and
+       * dispatches the queued events afterwards (see EventQueue). Pass
+       * nullptr to invoke callbacks inline again. The queue is not
+       * copied and must outlive its use.
+       *
+       * Only this instance's sources post into the queue, and only
+       * while it polls them, so each Eventuino can have its own.
+       */
+      void setEventQueue(EventQueue* queue) {
+        _eventQueue = queue;
+        _sink = queue;
+      }
+
+      /*
+       * Warm restart after a watchdog or brown-out reset. saveState
+       * writes a checksummed snapshot of every source's runtime state
+       * (see EventSource::saveState(...)), e.g. into a buffer declared
+       * with EVENTUINO_NOINIT, or one copied to EEPROM. It returns the
+       * bytes written, or 0 if capacity is less than snapshotSize(). Call
+       * it between polls, as often as the state is worth keeping.
+       *
+       * After a reset, call restoreState after begin(). It returns false,
+       * leaving the sources as they are, unless the snapshot is intact
+       * and was taken from the same number and types of sources, in the
+       * same order, e.g. when the buffer holds garbage after a power-on,
+       * a save was torn by the reset, or a firmware update reordered the
+       * sources. Otherwise the sources resume from the snapshot on the
+       * next poll(): toggles held on stay on without a second activate
+       * event, and timers expire on schedule, less the time spent in the
+       * reset.
+       */
+      uint16_t snapshotSize();
+      uint16_t saveState(uint8_t* buffer, uint16_t capacity);
+      bool restoreState(const uint8_t* buffer, uint16_t length);
+
   };
 }
 
@@ -0,0 +1,210 @@
+/*
+
+  ThreadedEventuino.cpp
+
+  Copyright (c) 2024, Dan Mowehhuk (danmowehhuk@gmail.com)
+  All rights reserved.
+
+*/
+
+#include "ThreadedEventuino.h"
+
+#if defined(NO_ARDUINO) && defined(HAL_LINUX)
+
+#include "hal/EventuinoHal.h"
+#include <condition_variable>
+#include <mutex>
+
+using namespace eventuino;
+
+namespace {
+
+struct QueuedEvent {
+  EventDelegate callback;
+  void* state;
+  uint32_t timestampMs;
+  uint8_t value;
+  uint8_t kind;
+};
+
+/*
+ * Bounded lock-free multi-producer, single-consumer queue (Vyukov's
+ * bounded queue, with a plain dequeue since only one thread pops)
+ */
+class WorkerQueue {
+
+  public:
+    explicit WorkerQueue(uint16_t capacity) {
+      size_t size = 2;
+      while (size < capacity) size <<= 1;
+      _mask = size - 1;
+      _cells = new Cell[size];
+      for (size_t i = 0; i < size; i++) {
+        _cells[i].sequence.store(i, std::memory_order_relaxed);
+      }
+    }
+    ~WorkerQueue() { delete[] _cells; }
+
+    bool push(const QueuedEvent& event) {
+      size_t pos = _head.load(std::memory_order_relaxed);
+      Cell* cell;
+      while (true) {
+        cell = &_cells[pos & _mask];
+        size_t seq = cell->sequence.load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        if (diff == 0) {
+          if (_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if (diff < 0) {
+          return false; // full
+        } else {
+          pos = _head.load(std::memory_order_relaxed);
+        }
+      }
+      cell->event = event;
+      cell->sequence.store(pos + 1, std::memory_order_release);
+      return true;
+    }
+
+    bool pop(QueuedEvent& event) {
+      Cell* cell = &_cells[_tail & _mask];
+      if (cell->sequence.load(std::memory_order_acquire) != _tail + 1) return false;
+      event = cell->event;
+      cell->sequence.store(_tail + _mask + 1, std::memory_order_release);
+      _tail++;
+      return true;
+    }
+
+  private:
+    struct Cell {
+      std::atomic<size_t> sequence;
+      QueuedEvent event;
+    };
+
+    Cell* _cells;
+    size_t _mask;
+    std::atomic<size_t> _head{0};
+    size_t _tail = 0; // consumer only
+
+};
+
+thread_local uint32_t currentEventTimestampMs = 0;
+
+}  // namespace
+
+struct ThreadedEventuino::Worker {
+
+  explicit Worker(uint16_t capacity): queue(capacity) {}
+
+  WorkerQueue queue;
+  std::thread thread;
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::atomic<bool> sleeping{false};
+  std::atomic<bool> running{false};
+
+  void notify() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleeping.load()) {
+      std::lock_guard<std::mutex> lock(mutex);
+      wake.notify_one();
+    }
+  }
+
+  void run() {
+    QueuedEvent event;
+    while (true) {
+      if (queue.pop(event)) {
+        currentEventTimestampMs = event.timestampMs;
+        event.callback(event.value, event.state);
+        continue;
+      }
+      if (!running.load()) break; // stopped, and nothing left to do
+
+      std::unique_lock<std::mutex> lock(mutex);
+      sleeping.store(true);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (!queue.pop(event)) {
+        if (running.load()) wake.wait(lock);
+        sleeping.store(false);
+        continue;
+      }
+      sleeping.store(false);
+      lock.unlock();
+      currentEventTimestampMs = event.timestampMs;
+      event.callback(event.value, event.state);
+    }
+  }
+
+};
+
+ThreadedEventuino::ThreadedEventuino(uint8_t workerCount, uint16_t queueCapacity):
+    _workerCount(workerCount ? workerCount : 1), _running(false), _dropped(0) {
+  _workers = new Worker*[_workerCount];
+  for (uint8_t i = 0; i < _workerCount; i++) {
+    _workers[i] = new Worker(queueCapacity);
+  }
+}
+
+ThreadedEventuino::~ThreadedEventuino() {
+  stop();
+  for (uint8_t i = 0; i < _workerCount; i++) {
+    delete _workers[i];
+  }
+  delete[] _workers;
+}
+
+void ThreadedEventuino::start(void* state) {
+  if (_running.load()) return;
+  _running.store(true);
+  _sink = this;  // installed by poll() on the detection thread only
+  for (uint8_t i = 0; i < _workerCount; i++) {
+    Worker& w = *_workers[i];
+    w.running.store(true);
+    w.thread = std::thread(&Worker::run, &w);
+  }
+  _detector = std::thread(&ThreadedEventuino::detect, this, state);
+}
+
+void ThreadedEventuino::stop() {
+  if (!_running.load()) return;
+  _running.store(false);
+  EventuinoHal::interruptWait();
+  _detector.join();
+  _sink = _eventQueue;
+
+  for (uint8_t i = 0; i < _workerCount; i++) {
+    Worker& w = *_workers[i];
+    {
+      std::lock_guard<std::mutex> lock(w.mutex);
+      w.running.store(false);
+      w.wake.notify_one();
+    }
+    w.thread.join();
+  }
+}
+
+uint32_t ThreadedEventuino::eventTimestampMs() {
+  return currentEventTimestampMs;
+}
+
+bool ThreadedEventuino::post(const EventDelegate& callback, 
+    uint8_t value, uint8_t kind, void* state) {
+  QueuedEvent event = { callback, state, (uint32_t)EventuinoHal::millis(), value, kind };
+  Worker& w = *_workers[value % _workerCount];
+  if (!w.queue.push(event)) {
+    _dropped++;
+    return true; // dropped, never run inline on the detection thread
+  }
+  w.notify();
+  return true;
+}
+
+void ThreadedEventuino::detect(void* state) {
+  while (_running.load()) {
+    poll(state);
+    uint16_t idle = idleMs();
+    EventuinoHal::waitForEdge(idle < _pollIntervalMs ? _pollIntervalMs : idle);
+  }
+}
+
+#endif  // NO_ARDUINO && HAL_LINUX
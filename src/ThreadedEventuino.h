@@ -0,0 +1,112 @@
+/*
+
+  ThreadedEventuino.h
+
+  A multi-threaded Eventuino runtime for Linux hosts (-DNO_ARDUINO
+  -DHAL_LINUX). One detection thread polls the event sources, handling
+  debouncing and timing, while a pool of worker threads invokes the
+  callbacks. A slow callback then no longer delays detection for every
+  other source.
+
+  Events for the same source value always go to the same worker, in
+  order, so a source's callbacks are never run concurrently or out of
+  order. Callbacks for different values may run concurrently and must
+  be thread-safe with respect to each other.
+
+  Only the standard callbacks (onPressed, onFlip, onExpire, routed
+  handlers, ...), bound to an EventDelegate or not, are handed to the
+  workers.
+  Others, such as onGroupChange, still run on the detection thread.
+
+  Copyright (c) 2024, Dan Mowehhuk (danmowehhuk@gmail.com)
+  All rights reserved.
+
+*/
+
+#ifndef ThreadedEventuino_h
+#define ThreadedEventuino_h
+
+#if defined(NO_ARDUINO) && defined(HAL_LINUX)
+
+#include "Eventuino.h"
+#include "EventSource.h"
+#include <atomic>
+#include <stdint.h>
+#include <thread>
+
+namespace eventuino {
+
+  class ThreadedEventuino: public Eventuino, private EventSink {
+
+    public:
+      /*
+       * workerCount   - Number of threads invoking callbacks
+       * queueCapacity - Events each worker can have pending (rounded up
+       *                 to a power of 2). Events arriving at a full
+       *                 worker are dropped and counted.
+       */
+      ThreadedEventuino(uint8_t workerCount = 2, uint16_t queueCapacity = 256);
+      ~ThreadedEventuino();
+
+      /*
+       * Starts the detection and worker threads. Call begin() first.
+       * The state argument is passed to every callback, as with poll().
+       * Do not call poll() while started.
+       */
+      void start(void* state = nullptr);
+
+      /*
+       * Stops detection, lets the workers finish every pending event,
+       * and joins all the threads.
+       */
+      void stop();
+
+      /*
+       * The detection thread sleeps at least this long between polls
+       * while any source wants polling as soon as possible (1ms
+       * default), and otherwise until idleMs() or the next pin edge.
+       */
+      void setPollIntervalMs(uint16_t ms) {
+        _pollIntervalMs = ms;
+      }
+
+      // Events dropped because their worker's queue was full
+      uint32_t droppedEvents() {
+        return _dropped.load();
+      }
+
+      /*
+       * Within a callback, the EventuinoHal::millis() at which the
+       * detection thread emitted the event being handled
+       */
+      static uint32_t eventTimestampMs();
+
+      // Disable moving and copying
+      ThreadedEventuino(ThreadedEventuino&& other) = delete;
+      ThreadedEventuino& operator=(ThreadedEventuino&& other) = delete;
+      ThreadedEventuino(const ThreadedEventuino&) = delete;
+      ThreadedEventuino& operator=(const ThreadedEventuino&) = delete;
+
+    private:
+      struct Worker;
+
+      Worker* *_workers;
+      uint8_t _workerCount;
+      uint16_t _pollIntervalMs = 1;
+      std::thread _detector;
+      std::atomic<bool> _running;
+      std::atomic<uint32_t> _dropped;
+
+      // required by EventSink, called on the detection thread
+      bool post(const EventDelegate& callback, uint8_t value,
+          uint8_t kind, void* state) override;
+
+      void detect(void* state);
+
+  };
+
+}
+
+#endif  // NO_ARDUINO && HAL_LINUX
+
+#endif
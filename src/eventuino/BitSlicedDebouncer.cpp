@@ -0,0 +1,227 @@
+#include "BitSlicedDebouncer.h"
+
+#if defined(NO_ARDUINO) && defined(HAL_LINUX)
+
+#if defined(__x86_64__) || defined(__i386__)
+#define EVENTUINO_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+using namespace eventuino;
+
+namespace {
+
+uint64_t _eventuinoElapsedScalar(const uint16_t* times, uint16_t now,
+    uint16_t threshold) {
+  uint64_t mask = 0;
+  for (uint8_t i = 0; i < 64; i++) {
+    if ((uint16_t)(now - times[i]) > threshold) mask |= (uint64_t)1 << i;
+  }
+  return mask;
+}
+
+#ifdef EVENTUINO_X86_KERNELS
+
+// Lanes where (now - times) > threshold, as 0xFF bytes after packing.
+// The subtraction wraps like the uint16_t arithmetic in DigitalPinSource,
+// and an unsigned x > t is a non-zero saturating x - t.
+uint64_t _eventuinoElapsedSse2(const uint16_t* times, uint16_t now,
+    uint16_t threshold) {
+  const __m128i vNow = _mm_set1_epi16(now);
+  const __m128i vThreshold = _mm_set1_epi16(threshold);
+  const __m128i zero = _mm_setzero_si128();
+  uint64_t notElapsed = 0;
+  for (uint8_t i = 0; i < 64; i += 16) {
+    __m128i a = _mm_loadu_si128((const __m128i*)(times + i));
+    __m128i b = _mm_loadu_si128((const __m128i*)(times + i + 8));
+    a = _mm_cmpeq_epi16(_mm_subs_epu16(_mm_sub_epi16(vNow, a), vThreshold), zero);
+    b = _mm_cmpeq_epi16(_mm_subs_epu16(_mm_sub_epi16(vNow, b), vThreshold), zero);
+    notElapsed |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_packs_epi16(a, b)) << i;
+  }
+  return ~notElapsed;
+}
+
+__attribute__((target("avx2")))
+uint64_t _eventuinoElapsedAvx2(const uint16_t* times, uint16_t now,
+    uint16_t threshold) {
+  const __m256i vNow = _mm256_set1_epi16(now);
+  const __m256i vThreshold = _mm256_set1_epi16(threshold);
+  const __m256i zero = _mm256_setzero_si256();
+  uint64_t notElapsed = 0;
+  for (uint8_t i = 0; i < 64; i += 32) {
+    __m256i a = _mm256_loadu_si256((const __m256i*)(times + i));
+    __m256i b = _mm256_loadu_si256((const __m256i*)(times + i + 16));
+    a = _mm256_cmpeq_epi16(_mm256_subs_epu16(_mm256_sub_epi16(vNow, a), vThreshold), zero);
+    b = _mm256_cmpeq_epi16(_mm256_subs_epu16(_mm256_sub_epi16(vNow, b), vThreshold), zero);
+    // packs works within 128-bit halves, so put the quarters back in order
+    __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi16(a, b), 0xD8);
+    notElapsed |= (uint64_t)(uint32_t)_mm256_movemask_epi8(packed) << i;
+  }
+  return ~notElapsed;
+}
+
+#endif
+
+uint64_t* _eventuinoNewPlane(uint32_t words, uint64_t fill) {
+  uint64_t* plane = new uint64_t[words];
+  for (uint32_t w = 0; w < words; w++) plane[w] = fill;
+  return plane;
+}
+
+uint16_t* _eventuinoNewTimes(uint32_t words) {
+  uint16_t* times = new uint16_t[words * 64];
+  for (uint32_t i = 0; i < words * 64; i++) times[i] = 0;
+  return times;
+}
+
+}
+
+BitSlicedDebouncer::BitSlicedDebouncer(uint32_t inputCount,
+      uint8_t debounceDelayMs, uint16_t longHoldDelayMs, uint8_t repeatMs):
+    EventSource(), _inputCount(inputCount), _wordCount((inputCount + 63) / 64),
+    _longHoldDelayMs(longHoldDelayMs), _debounceDelayMs(debounceDelayMs),
+    _repeatMs(repeatMs) {
+  // Inputs start HIGH, matching DigitalPinSource's initial state. The
+  // padding past inputCount stays HIGH, so it never changes.
+  _raw = _eventuinoNewPlane(_wordCount, ~(uint64_t)0);
+  _prev = _eventuinoNewPlane(_wordCount, ~(uint64_t)0);
+  _curr = _eventuinoNewPlane(_wordCount, ~(uint64_t)0);
+  _active = _eventuinoNewPlane(_wordCount, 0);
+  _longHold = _eventuinoNewPlane(_wordCount, 0);
+  _repeat = _eventuinoNewPlane(_wordCount, 0);
+  _toggleTime = _eventuinoNewTimes(_wordCount);
+  _lastRepeat = _eventuinoNewTimes(_wordCount);
+  if (!setKernel(KERNEL_AVX2) && !setKernel(KERNEL_SSE2)) {
+    setKernel(KERNEL_SCALAR);
+  }
+}
+
+BitSlicedDebouncer::~BitSlicedDebouncer() {
+  delete[] _raw;
+  delete[] _prev;
+  delete[] _curr;
+  delete[] _active;
+  delete[] _longHold;
+  delete[] _repeat;
+  delete[] _toggleTime;
+  delete[] _lastRepeat;
+}
+
+bool BitSlicedDebouncer::setKernel(kernel_t kernel) {
+  elapsedMask_t elapsedMask = 0;
+  switch (kernel) {
+    case KERNEL_SCALAR:
+      elapsedMask = _eventuinoElapsedScalar;
+      break;
+#ifdef EVENTUINO_X86_KERNELS
+    case KERNEL_SSE2:
+      if (__builtin_cpu_supports("sse2")) elapsedMask = _eventuinoElapsedSse2;
+      break;
+    case KERNEL_AVX2:
+      if (__builtin_cpu_supports("avx2")) elapsedMask = _eventuinoElapsedAvx2;
+      break;
+#endif
+    default:
+      break;
+  }
+  if (elapsedMask == 0) return false;
+  _kernel = kernel;
+  _elapsedMask = elapsedMask;
+  return true;
+}
+
+void BitSlicedDebouncer::setInput(uint32_t index, uint8_t level) {
+  if (index >= _inputCount) return;
+  uint64_t bit = (uint64_t)1 << (index & 63);
+  if (level == EventuinoHal::LOW_STATE) {
+    _raw[index >> 6] &= ~bit;
+  } else {
+    _raw[index >> 6] |= bit;
+  }
+}
+
+void BitSlicedDebouncer::enableRepeat(uint32_t index, bool b) {
+  if (index >= _inputCount) return;
+  uint64_t bit = (uint64_t)1 << (index & 63);
+  if (b) {
+    _repeat[index >> 6] |= bit;
+  } else {
+    _repeat[index >> 6] &= ~bit;
+  }
+}
+
+bool BitSlicedDebouncer::isActive(uint32_t index) {
+  return index < _inputCount && ((_active[index >> 6] >> (index & 63)) & 1);
+}
+
+bool BitSlicedDebouncer::isLongHold(uint32_t index) {
+  return index < _inputCount && ((_longHold[index >> 6] >> (index & 63)) & 1);
+}
+
+void BitSlicedDebouncer::pollAt(uint16_t now, void* state) {
+  // Keep the padding past inputCount HIGH, in case inputWords() cleared it
+  uint64_t padding = (_inputCount & 63) ? ~(uint64_t)0 << (_inputCount & 63) : 0;
+
+  for (uint32_t w = 0; w < _wordCount; w++) {
+    uint64_t reading = _raw[w] | (w == _wordCount - 1 ? padding : 0);
+    uint16_t* toggleTime = _toggleTime + w * 64;
+    uint16_t* lastRepeat = _lastRepeat + w * 64;
+
+    // Pin state has changed, but might be noise
+    uint64_t bounced = reading ^ _prev[w];
+    _prev[w] = reading;
+    for (uint64_t m = bounced; m; m &= m - 1) {
+      toggleTime[__builtin_ctzll(m)] = now;
+    }
+
+    // Only inputs still settling on a change or held LOW need their
+    // timestamps checked. A bounced input was just stamped, so it can't
+    // be steady yet.
+    uint64_t pending = ~bounced & ((reading ^ _curr[w]) | ~reading);
+    if (pending == 0) continue;
+    uint64_t steady = pending & _elapsedMask(toggleTime, now, _debounceDelayMs);
+    if (steady == 0) continue;
+
+    uint64_t changed = steady & (reading ^ _curr[w]);
+    uint64_t pressed = changed & ~reading;
+    uint64_t released = changed & reading;
+    _curr[w] ^= changed;
+    _active[w] = (_active[w] | pressed) & ~released;
+    _longHold[w] &= ~released;
+    for (uint64_t m = pressed; m; m &= m - 1) {
+      lastRepeat[__builtin_ctzll(m)] = now;
+    }
+    for (uint64_t m = released; m; m &= m - 1) {
+      uint8_t i = __builtin_ctzll(m);
+      toggleTime[i] = 0;
+      lastRepeat[i] = 0;
+    }
+
+    // State is unchanged, check for long hold
+    uint64_t held = steady & ~changed & ~reading;
+    uint64_t longHeld = 0;
+    if (held) {
+      held &= _elapsedMask(toggleTime, now, _longHoldDelayMs);
+      if (held) held &= _elapsedMask(lastRepeat, now, _repeatMs);
+      // The initial long hold always fires, later ones only with repeat
+      longHeld = held & (~_longHold[w] | _repeat[w]);
+      _longHold[w] |= held;
+      for (uint64_t m = longHeld; m; m &= m - 1) {
+        lastRepeat[__builtin_ctzll(m)] = now;
+      }
+    }
+
+    // Callbacks last, in index order, once the word's state is settled
+    for (uint64_t m = changed | longHeld; m; m &= m - 1) {
+      uint8_t i = __builtin_ctzll(m);
+      uint32_t index = w * 64 + i;
+      if ((changed >> i) & 1) {
+        if (onChange != 0) onChange(index, (pressed >> i) & 1, state);
+      } else if (onLongHold != 0) {
+        onLongHold(index, state);
+      }
+    }
+  }
+}
+
+#endif
@@ -0,0 +1,148 @@
+/*
+
+  Eventuino_BitSlicedDebouncer.h
+
+  Debounces a very large array of virtual digital inputs at once, for
+  Linux hosts (-DNO_ARDUINO -DHAL_LINUX) simulating thousands of
+  switches. Each input follows exactly the DEBOUNCE_STABLE, long hold
+  and repeat behavior of DigitalPinSource::poll(), but instead of one
+  object per input, the raw, previous and debounced states are stored
+  as bit planes, 64 inputs to a word, and updated with bitwise
+  operations. Per-input timestamps are kept in plain 16-bit arrays and
+  compared 8 (SSE2) or 16 (AVX2) at a time, with a scalar fallback.
+
+  Words whose inputs are all steady and HIGH are skipped without
+  touching their timestamps, and only the inputs that changed state or
+  reached a long hold invoke the callbacks, in index order.
+
+  As with DigitalPinSource, "active" means the input reads LOW, and
+  inputs start out HIGH. Unlike it, the inputs aren't saved by
+  Eventuino::saveState(...), since their state is far larger than a
+  snapshot entry's 255 bytes; after a restart they start afresh.
+
+  Copyright (c) 2024, Dan Mowehhuk (danmowehhuk@gmail.com)
+  All rights reserved.
+
+*/
+
+#ifndef eventuino_BitSlicedDebouncer_h
+#define eventuino_BitSlicedDebouncer_h
+
+#if defined(NO_ARDUINO) && defined(HAL_LINUX)
+
+#include "../EventSource.h"
+#include "../hal/EventuinoHal.h"
+
+namespace eventuino {
+
+  class BitSlicedDebouncer: public EventSource {
+
+    public:
+      /*
+       * inputCount      - Number of virtual inputs, indexed from 0
+       * debounceDelayMs, longHoldDelayMs, repeatMs - As for
+       *                   DigitalPinSource, shared by all inputs
+       */
+      BitSlicedDebouncer(uint32_t inputCount, uint8_t debounceDelayMs = 75,
+          uint16_t longHoldDelayMs = 1000, uint8_t repeatMs = 200);
+      ~BitSlicedDebouncer();
+
+      void setup() override {};
+
+      // Debounces every input against EventuinoHal::millis()
+      void poll(void* state = nullptr) override {
+        pollAt(EventuinoHal::millis(), state);
+      };
+
+      // Debounces every input as of the given time (truncated millis)
+      void pollAt(uint16_t now, void* state = nullptr);
+
+      // The inputs are written directly, so there are no edges to wait on
+      uint16_t idleMs() override {
+        return 0;
+      };
+
+      typedef void (*changeCallback_t)(uint32_t index, bool isActive, void* state);
+      typedef void (*longHoldCallback_t)(uint32_t index, void* state);
+
+      // Called when an input's debounced state changes
+      changeCallback_t onChange = 0;
+
+      // Called on an input's long hold, and repeatedly if repeat is enabled
+      longHoldCallback_t onLongHold = 0;
+
+      // Sets an input's raw level (EventuinoHal::LOW_STATE or HIGH_STATE)
+      void setInput(uint32_t index, uint8_t level);
+
+      /*
+       * The raw levels as words of 64 inputs, bit (index % 64) of word
+       * (index / 64), 1 for HIGH. For writing many inputs at once.
+       */
+      uint64_t* inputWords() {
+        return _raw;
+      };
+
+      uint32_t inputCount() {
+        return _inputCount;
+      };
+
+      // Per-input equivalent of DigitalPinSource::enableRepeat
+      void enableRepeat(uint32_t index, bool b);
+
+      bool isActive(uint32_t index);
+      bool isLongHold(uint32_t index);
+
+      /*
+       * The timestamp comparison kernels. The best one the CPU supports
+       * is selected on construction; setKernel returns false if the
+       * requested one is unavailable.
+       */
+      enum kernel_t : uint8_t {
+        KERNEL_SCALAR = 0,
+        KERNEL_SSE2,
+        KERNEL_AVX2
+      };
+      bool setKernel(kernel_t kernel);
+      kernel_t kernel() {
+        return _kernel;
+      };
+
+      // Disable copying
+      BitSlicedDebouncer(const BitSlicedDebouncer&) = delete;
+      BitSlicedDebouncer& operator=(const BitSlicedDebouncer&) = delete;
+
+      // Returns a 64-lane mask of (uint16_t)(now - times[i]) > threshold
+      typedef uint64_t (*elapsedMask_t)(const uint16_t* times, uint16_t now,
+          uint16_t threshold);
+
+    private:
+      BitSlicedDebouncer() = delete;
+
+      uint32_t _inputCount;
+      uint32_t _wordCount;
+
+      // Bit planes, one bit per input
+      uint64_t* _raw;
+      uint64_t* _prev;
+      uint64_t* _curr;
+      uint64_t* _active;
+      uint64_t* _longHold;
+      uint64_t* _repeat;
+
+      // One entry per input, padded to a whole word
+      uint16_t* _toggleTime;
+      uint16_t* _lastRepeat;
+
+      uint16_t _longHoldDelayMs;
+      uint8_t _debounceDelayMs;
+      uint8_t _repeatMs;
+      kernel_t _kernel;
+      elapsedMask_t _elapsedMask;
+
+  };
+
+}
+
+#endif
+
+#endif
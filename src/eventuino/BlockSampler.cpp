@@ -0,0 +1,136 @@
+#include "BlockSampler.h"
+#include "../hal/EventuinoHal.h"
+
+BlockSampler::BlockSampler(const uint8_t* pins, uint8_t channelCount,
+      uint16_t blockFrames, uint32_t periodMicros, uint8_t value):
+    BlockSampler(pins, channelCount, blockFrames, periodMicros, value, nullptr) {};
+
+BlockSampler::BlockSampler(const uint8_t* pins, uint8_t channelCount,
+      uint16_t blockFrames, uint32_t periodMicros, uint8_t value,
+      analogReadCallback_t readCallback):
+    EventSource(), _pins(pins), _doAnalogRead(readCallback),
+    _periodMicros(periodMicros > 0 ? periodMicros : 1),
+    _blockFrames(blockFrames > 0 ? blockFrames : 1), _value(value) {
+  _channelCount = channelCount == 0 ? 1 : (channelCount > 8 ? 8 : channelCount);
+  _blockSamples = _blockFrames * _channelCount;
+  _samples = new uint16_t[2 * _blockSamples];
+};
+
+BlockSampler::BlockSampler(uint8_t channelCount, uint16_t blockFrames, uint8_t value):
+    BlockSampler(nullptr, channelCount, blockFrames, 0, value, nullptr) {};
+
+BlockSampler::~BlockSampler() {
+  delete[] _samples;
+  _samples = nullptr;
+}
+
+void BlockSampler::start() {
+  uint8_t saved = EventuinoHal::enterCritical();
+  _index = 0;
+  _channel = 0;
+  _filling = 0;
+  _ready = 0;
+  _next = 0;
+  _overrunCount = 0;
+  _converting = false;
+  _nextTick = EventuinoHal::micros();
+  _running = true;
+  EventuinoHal::exitCritical(saved);
+}
+
+void BlockSampler::stop() {
+  _running = false;
+  _converting = false;
+}
+
+bool BlockSampler::pushFromIsr(uint16_t sample) {
+  if (!_running) return false;
+  return store(sample);
+}
+
+uint16_t BlockSampler::getOverrunCount() {
+  uint8_t saved = EventuinoHal::enterCritical();
+  uint16_t count = _overrunCount;
+  EventuinoHal::exitCritical(saved);
+  return count;
+}
+
+void BlockSampler::poll(void* state) {
+  if (_running && _pins != nullptr) sample(state);
+  dispatch(state);
+}
+
+uint16_t BlockSampler::idleMs() {
+  if (_ready != 0) return 0;
+  if (!_running) return 0xFFFF;
+  // Samples pushed from an interrupt can fill a block at any time
+  if (_pins == nullptr || _converting) return 0;
+  int32_t remaining = (int32_t)(_nextTick - (uint32_t)EventuinoHal::micros());
+  if (remaining <= 0) return 0;
+  return remaining / 1000 > 0xFFFF ? 0xFFFF : remaining / 1000;
+}
+
+void BlockSampler::sample(void*) {
+  if (_converting) {
+    if (!EventuinoHal::analogReady()) return;
+    _converting = false;
+    store(EventuinoHal::analogResult());
+    if (_channel != 0) {
+      // The rest of this tick's channels
+      EventuinoHal::analogStart(_pins[_channel]);
+      _converting = true;
+      return;
+    }
+  }
+
+  uint32_t now = EventuinoHal::micros();
+  uint32_t late = now - _nextTick;
+  if ((int32_t)late < 0) return;
+  if (late >= _periodMicros) {
+    // Polled too late for some ticks; skip them rather than bunching up
+    uint32_t skipped = late / _periodMicros;
+    _nextTick += skipped * _periodMicros;
+    _overrunCount = _overrunCount + skipped > 0xFFFF ? 0xFFFF : _overrunCount + skipped;
+  }
+  _nextTick += _periodMicros;
+
+  if (_doAnalogRead != 0) {
+    for (uint8_t i = 0; i < _channelCount; i++) {
+      store(_doAnalogRead(_pins[i]));
+    }
+    return;
+  }
+  EventuinoHal::analogStart(_pins[0]);
+  _converting = true;
+}
+
+bool BlockSampler::store(uint16_t sample) {
+  uint8_t channel = _channel;
+  _channel = channel + 1 < _channelCount ? channel + 1 : 0;
+  if (_index == 0 && (channel != 0 || (_ready & (1 << _filling)) != 0)) {
+    // Buffers only start at a frame, once onBlock has released them
+    if (channel == 0 && _overrunCount < 0xFFFF) _overrunCount++;
+    return false;
+  }
+  _samples[_filling * _blockSamples + _index] = sample;
+  if (++_index == _blockSamples) {
+    _ready |= 1 << _filling;
+    _filling ^= 1;
+    _index = 0;
+  }
+  return true;
+}
+
+void BlockSampler::dispatch(void* state) {
+  // At most both buffers, oldest first
+  for (uint8_t i = 0; i < 2; i++) {
+    if ((_ready & (1 << _next)) == 0) return;
+    if (onBlock != 0) {
+      onBlock(_value, _samples + _next * _blockSamples, _blockFrames, state);
+    }
+    uint8_t saved = EventuinoHal::enterCritical();
+    _ready &= ~(1 << _next);
+    EventuinoHal::exitCritical(saved);
+    _next ^= 1;
+  }
+}
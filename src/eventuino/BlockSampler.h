@@ -0,0 +1,143 @@
+/*
+
+  eventuino::BlockSampler.h
+
+  Samples analog channels at a fixed rate into blocks, and invokes one
+  callback per filled block with the samples, instead of one per sample.
+  Two buffers alternate: one fills while the other is handed to onBlock,
+  so processing a block doesn't stall acquisition.
+
+  Samples are acquired either:
+  - Polled: poll() starts each conversion on schedule and collects it
+    without blocking, on a drift-free period. Sampling is as precise as
+    the loop polls; ticks that come due more than a period late are
+    skipped and counted as overruns.
+  - From an interrupt: a hardware timer or the ADC's own interrupt (e.g.
+    with the ADC auto-triggered by a timer) calls pushFromIsr(...) with
+    each sample, and poll() only hands the filled blocks to onBlock.
+
+  With several channels, each tick samples every channel in turn, and
+  the samples are interleaved in the block: channel 0, 1, ..., then the
+  next frame.
+
+  Invokes callback functions for:
+  - onBlock
+
+  Uses 4 bytes per sample per block (2 buffers), plus 34 bytes.
+
+  Copyright (c) 2024, Dan Mowehhuk (danmowehhuk@gmail.com)
+  All rights reserved.
+
+*/
+
+#ifndef eventuino_BlockSampler_h
+#define eventuino_BlockSampler_h
+
+#include "../EventSource.h"
+
+using namespace eventuino;
+
+class BlockSampler: public EventSource {
+
+  public:
+    // disable default constructor
+    BlockSampler() = delete;
+
+    /*
+     * Constructor for polled sampling through the HAL's ADC
+     *
+     * pins         - The analog pins to sample (up to 8). The array is
+     *                not copied and must outlive the sampler.
+     * channelCount - Number of pins
+     * blockFrames  - Ticks per block; a block holds
+     *                blockFrames * channelCount samples
+     * periodMicros - Time between ticks
+     * value        - The value passed to onBlock
+     */
+    BlockSampler(const uint8_t* pins, uint8_t channelCount, uint16_t blockFrames,
+        uint32_t periodMicros, uint8_t value);
+
+    /*
+     * Constructor for polled sampling using a custom callback, e.g. for
+     * an external ADC. The read converts synchronously.
+     */
+    typedef uint16_t (*analogReadCallback_t)(uint8_t pin);
+    BlockSampler(const uint8_t* pins, uint8_t channelCount, uint16_t blockFrames,
+        uint32_t periodMicros, uint8_t value, analogReadCallback_t readCallback);
+
+    /*
+     * Constructor for samples pushed from an interrupt with
+     * pushFromIsr(...)
+     */
+    BlockSampler(uint8_t channelCount, uint16_t blockFrames, uint8_t value);
+
+    ~BlockSampler();
+
+    /*
+     * Called with each filled block. The samples are only valid until
+     * the callback returns; the buffer is then refilled.
+     */
+    typedef void (*blockCallback_t)(uint8_t value, const uint16_t* samples,
+        uint16_t frameCount, void* state);
+    blockCallback_t onBlock = 0;
+
+    // Starts sampling into an empty block, with the first tick due now
+    void start();
+
+    // Stops sampling. Blocks already filled are still handed to onBlock.
+    void stop();
+
+    bool isRunning() {
+      return _running;
+    }
+
+    /*
+     * Adds the next sample, from an interrupt handler. Returns false if
+     * the sampler isn't running, or the sample was dropped because both
+     * buffers are still waiting on onBlock (an overrun).
+     */
+    bool pushFromIsr(uint16_t sample);
+
+    // Frames dropped, or ticks skipped, since start()
+    uint16_t getOverrunCount();
+
+    uint8_t getValue() {
+      return _value;
+    }
+
+    void setup() override {};
+    void poll(void* state = nullptr) override;
+    uint16_t idleMs() override;
+
+    // Disable moving and copying
+    BlockSampler(BlockSampler&& other) = delete;
+    BlockSampler& operator=(BlockSampler&& other) = delete;
+    BlockSampler(const BlockSampler&) = delete;
+    BlockSampler& operator=(const BlockSampler&) = delete;
+
+  private:
+    void sample(void* state);
+    bool store(uint16_t sample);
+    void dispatch(void* state);
+
+    const uint8_t* _pins;
+    analogReadCallback_t _doAnalogRead;
+    uint16_t* _samples;  // both buffers, one after the other
+    uint32_t _periodMicros;
+    uint32_t _nextTick = 0;
+    uint16_t _blockFrames;
+    uint16_t _blockSamples;
+    volatile uint16_t _index = 0;  // next sample in the filling buffer
+    volatile uint16_t _overrunCount = 0;
+    uint8_t _channelCount;
+    uint8_t _value;
+    volatile uint8_t _channel = 0;  // channel of the next sample
+    volatile uint8_t _filling = 0;  // buffer being filled
+    volatile uint8_t _ready = 0;    // bit per buffer waiting on onBlock
+    uint8_t _next = 0;              // buffer to hand to onBlock next
+    bool _converting = false;
+    bool _running = false;
+
+};
+
+#endif
@@ -3,17 +3,15 @@
 using namespace eventuino;
 
 void Button::onChange(uint8_t value, void* state) {
-  if (isActive() && onPressed != 0) {
-    onPressed(value, state);
-  } else if (!isActive() && onReleased != 0) {
-    onReleased(value, state);
+  if (isActive()) {
+    emit(onPressed, value, KIND_ACTIVATE, state);
+  } else {
+    emit(onReleased, value, KIND_DEACTIVATE, state);
   }
 }
 
 void Button::onLongHold(uint8_t value, void* state) {
-  if (onLongPress != 0) {
-    onLongPress(value, state);
-  }
+  emit(onLongPress, value, KIND_LONG_HOLD, state);
 }
 
 bool Button::isPressed() {
@@ -9,7 +9,7 @@
   - onLongPress
   - onReleased
 
-  Uses 21 bytes of global variable space per button.
+  Uses 34 bytes of global variable space per button.
 
   NOTE: The button pin is expected to be HIGH when the button is not pressed.
 
@@ -50,9 +50,9 @@ class Button: public DigitalPinSource {
         pinSetupCallback_t setupCallback, digitalReadCallback_t readCallback):
         DigitalPinSource(pinNumber, value, setupCallback, readCallback) {};
 
-    eventuinoCallback_t onPressed = 0;
-    eventuinoCallback_t onReleased = 0;
-    eventuinoCallback_t onLongPress = 0;
+    EventDelegate onPressed;
+    EventDelegate onReleased;
+    EventDelegate onLongPress;
     void clearCallbacks();
 
     bool isPressed();
@@ -75,4 +75,48 @@ class Button: public DigitalPinSource {
 
 };
 
+/*
+ * A Button whose debounce, long hold and repeat delays are compile-time
+ * constants rather than the static delays shared by every DigitalPinSource,
+ * so different kinds of buttons can have different timing and the delays
+ * cost no memory loads when polling. The setDebounceDelayMs etc. setters
+ * have no effect on a BasicButton.
+ *
+ * Template params:
+ *   DebounceMs - debounce delay (default 75ms)
+ *   HoldMs     - long hold delay (default 1s)
+ *   RepeatMs   - repeat delay, if enableRepeat(true) (default 200ms)
+ */
+template<uint8_t DebounceMs = 75, uint16_t HoldMs = 1000, uint8_t RepeatMs = 200>
+class BasicButton: public Button {
+
+  public:
+    BasicButton() = delete;
+
+    BasicButton(uint8_t pinNumber, uint8_t value): Button(pinNumber, value) {};
+
+    BasicButton(uint8_t pinNumber, uint8_t value, 
+        pinSetupCallback_t setupCallback, digitalReadCallback_t readCallback):
+        Button(pinNumber, value, setupCallback, readCallback) {};
+
+    void poll(void* state = nullptr) override {
+      pollTimed(DebounceMs, HoldMs, RepeatMs, state);
+    };
+
+    uint16_t idleMs() override {
+      return idleTimed(DebounceMs, HoldMs, RepeatMs);
+    };
+
+    // Allow moving
+    BasicButton(BasicButton&& other) noexcept: Button(this->move(other)) {};
+    BasicButton& operator=(BasicButton&& other) noexcept {
+      Button::operator=(this->move(other));
+      return *this;
+    };
+    // Disable copying
+    BasicButton(const BasicButton&) = delete;
+    BasicButton& operator=(const BasicButton&) = delete;
+
+};
+
 #endif
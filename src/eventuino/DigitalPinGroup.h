@@ -0,0 +1,177 @@
+/*
+
+  eventuino::DigitalPinGroup.h
+
+  Polls a set of DigitalPinSources (Buttons, Toggles, etc.) together and
+  coalesces all of their debounced changes within one poll into a single
+  callback - useful for chords, ganged switches, or recomputing state
+  that depends on several inputs only once per poll.
+
+  Invokes callback functions for:
+  - onGroupChange
+
+  Bit i of each mask refers to the i-th source added to the group, and
+  is 1 while that source is active. The members' own callbacks are still
+  invoked as usual.
+
+  Use one of the following group classes:
+  - DigitalPinGroup8: up to 8 sources
+  - DigitalPinGroup16: up to 16 sources
+  - DigitalPinGroup32: up to 32 sources
+
+  NOTE: Add the group to Eventuino, but not its members, or the members
+  will be polled twice.
+
+  Copyright (c) 2024, Dan Mowehhuk (danmowehhuk@gmail.com)
+  All rights reserved.
+
+*/
+
+#ifndef eventuino_DigitalPinGroup_h
+#define eventuino_DigitalPinGroup_h
+
+#include "DigitalPinSource.h"
+
+using namespace eventuino;
+
+namespace eventuino {
+
+  /*
+   * Do not use the DigitalPinGroup class directly. Instead, use
+   * DigitalPinGroup8, DigitalPinGroup16 or DigitalPinGroup32.
+   *
+   * Template params:
+   *   M - an unsigned int type holding one bit per source
+   */
+  template<class M> class DigitalPinGroup: public EventSource {
+
+    public:
+      DigitalPinGroup() {};
+      ~DigitalPinGroup() {
+        if (_sources) delete[] _sources;
+        _sources = nullptr;
+        _sourceCount = 0;
+      };
+
+      /*
+       * Add a source to the group. Returns false if the group is full.
+       */
+      bool addSource(DigitalPinSource* source) {
+        if (_sourceCount >= sizeof(M) * 8) return false;
+        DigitalPinSource** newSources = new DigitalPinSource*[_sourceCount + 1];
+        for (uint8_t i = 0; i < _sourceCount; i++) {
+          newSources[i] = _sources[i];
+        }
+        newSources[_sourceCount] = source;
+
+        delete[] _sources;
+        _sources = newSources;
+        if (source->isActive()) _stateMask |= (M)1 << _sourceCount;
+        _sourceCount++;
+        return true;
+      };
+
+      void setup() override {
+        for (uint8_t i = 0; i < _sourceCount; i++) {
+          _sources[i]->setup();
+        }
+      };
+
+      // Seeds every member, then reports them all as changed at once
+      void seedState(bool notify, void* state = nullptr) override {
+        M allMask = 0;
+        _stateMask = 0;
+        for (uint8_t i = 0; i < _sourceCount; i++) {
+          DigitalPinSource* src = _sources[i];
+          src->seedState(notify, state);
+          M bit = (M)1 << i;
+          allMask |= bit;
+          if (src->isActive()) _stateMask |= bit;
+        }
+        if (notify && onGroupChange != 0) {
+          onGroupChange(allMask, _stateMask, state);
+        }
+      };
+
+      void poll(void* state = nullptr) override {
+        M changedMask = 0;
+        for (uint8_t i = 0; i < _sourceCount; i++) {
+          DigitalPinSource* src = _sources[i];
+          src->poll(state);
+          M bit = (M)1 << i;
+          if (((_stateMask & bit) != 0) != src->isActive()) {
+            changedMask |= bit;
+          }
+        }
+        if (changedMask == 0) return;
+        _stateMask ^= changedMask;
+        if (onGroupChange != 0) {
+          onGroupChange(changedMask, _stateMask, state);
+        }
+      };
+
+      /*
+       * Saves every member's state, back to back, so toggles held on in
+       * the group stay on after a warm restart without a second activate
+       * or onGroupChange. A snapshot from a group of a different size is
+       * ignored.
+       */
+      uint8_t snapshotMax() override {
+        uint16_t size = 0;
+        for (uint8_t i = 0; i < _sourceCount; i++) {
+          size += _sources[i]->snapshotMax();
+        }
+        return size > 0xFF ? 0 : size;
+      };
+      uint8_t snapshotLayout() override {
+        return SNAPSHOT_DIGITAL_PIN_GROUP;
+      };
+      uint8_t saveState(uint8_t* buffer) override {
+        if (snapshotMax() == 0) return 0;
+        uint8_t length = 0;
+        for (uint8_t i = 0; i < _sourceCount; i++) {
+          length += _sources[i]->saveState(buffer + length);
+        }
+        return length;
+      };
+      void restoreState(const uint8_t* buffer, uint8_t length) override {
+        if (length == 0 || length != snapshotMax()) return;
+        _stateMask = 0;
+        for (uint8_t i = 0; i < _sourceCount; i++) {
+          DigitalPinSource* src = _sources[i];
+          src->restoreState(buffer, src->snapshotMax());
+          buffer += src->snapshotMax();
+          if (src->isActive()) _stateMask |= (M)1 << i;
+        }
+      };
+
+      /*
+       * Which sources were active as of the last poll
+       */
+      M stateMask() {
+        return _stateMask;
+      };
+
+      typedef void (*groupCallback_t)(M changedMask, M stateMask, void* state);
+      groupCallback_t onGroupChange = 0;
+
+      // Disable moving and copying
+      DigitalPinGroup(DigitalPinGroup&& other) = delete;
+      DigitalPinGroup& operator=(DigitalPinGroup&& other) = delete;
+      DigitalPinGroup(const DigitalPinGroup&) = delete;
+      DigitalPinGroup& operator=(const DigitalPinGroup&) = delete;
+
+    private:
+      DigitalPinSource* *_sources = nullptr;
+      uint8_t _sourceCount = 0;
+      M _stateMask = 0;
+
+  };
+
+  class DigitalPinGroup8: public DigitalPinGroup<uint8_t> {};
+  class DigitalPinGroup16: public DigitalPinGroup<uint16_t> {};
+  class DigitalPinGroup32: public DigitalPinGroup<uint32_t> {};
+
+}
+
+#endif
@@ -9,6 +9,17 @@ uint16_t DigitalPinSource::_longHoldDelayMs = 1000;
 uint8_t DigitalPinSource::_repeatMs = 200;
 uint8_t DigitalPinSource::_debounceDelayMs = 75;
 
+const uint8_t DigitalPinSource::_transitions[8] = {
+  TR_HOLD,                  // LOW,  curr LOW,  prev LOW
+  TR_BOUNCE,                // LOW,  curr LOW,  prev HIGH
+  TR_SETTLE | TR_ACTIVATE,  // LOW,  curr HIGH, prev LOW
+  TR_BOUNCE,                // LOW,  curr HIGH, prev HIGH
+  TR_BOUNCE,                // HIGH, curr LOW,  prev LOW
+  TR_SETTLE,                // HIGH, curr LOW,  prev HIGH
+  TR_BOUNCE,                // HIGH, curr HIGH, prev LOW
+  0                         // HIGH, curr HIGH, prev HIGH
+};
+
 void _eventuinoPinSetupDefault(uint8_t pinNumber) {
   EventuinoHal::pinModeInputPullup(pinNumber);
 }
@@ -28,99 +39,101 @@ DigitalPinSource::DigitalPinSource(uint8_t pinNumber, uint8_t value,
     _doPinSetup(setupCallback),
     _doDigitalRead(readCallback) {};
 
-void DigitalPinSource::poll(void* state) {
-  uint16_t now = EventuinoHal::millis(); // trunc to last 16-bits (32s)
-  uint8_t reading = _doDigitalRead(_pinNumber);
-
-  if (reading != prevState()) {
-    // Pin state has changed, but might be noise
-    _toggleTime = now;
-    setPrevState(reading);
-  }
-
-  if ((now - _toggleTime) > _debounceDelayMs) {
-    // Pin state is steady, ready to check for events
-    // Start by storing the new state
-    uint8_t prevState = currState();
-    setCurrState(reading);
-
-    if (reading != prevState) {
-      // State has changed
-
-      if (reading == EventuinoHal::LOW_STATE && prevState == EventuinoHal::HIGH_STATE) {
-        // State changed from inactive to active
-        _lastRepeat = now;
-        setIsActive(true);
-      } else {
-        // State changed from active to inactive
-        _toggleTime = 0;
-        _lastRepeat = 0;
-        setIsActive(false);
-        setIsLongHold(false);
-      }
-      onChange(_value, state);
-
-    } else {
-      // State is unchanged, check for long hold
-
-      if (reading == EventuinoHal::LOW_STATE &&
-          (now - _toggleTime > _longHoldDelayMs) &&
-          (now - _lastRepeat > _repeatMs)) {
-        // Pin has been active long enough for long hold
-        // Possibly also a repeat long hold if repeat enabled
-
-        bool isInitialLongHold = !isLongHold();
-        setIsLongHold(true);
-        if (isInitialLongHold || isRepeatEnabled()) {
-          onLongHold(_value, state);
-          _lastRepeat = now;
-        } else {
-          // This is repeat pass, and repeat is disabled - do nothing
-        }  
-      }
+void DigitalPinSource::setup() {
+  _doPinSetup(_pinNumber);
+  resolveInputRegister();
+}
 
-    }
+void DigitalPinSource::resolveInputRegister() {
+  _inputRegister = nullptr;
+  if (_doDigitalRead == _eventuinoDigitalReadDefault) {
+    _inputRegister = EventuinoHal::inputRegister(_pinNumber, _inputMask);
   }
 }
 
-bool DigitalPinSource::isRepeatEnabled() {
-  return bitRead(_state, 4);
+void DigitalPinSource::poll(void* state) {
+  pollTimed(_debounceDelayMs, _longHoldDelayMs, _repeatMs, state);
 }
 
-void DigitalPinSource::enableRepeat(bool b) {
-  bitWrite(_state, 4, b);
+uint16_t DigitalPinSource::idleMs() {
+  return idleTimed(_debounceDelayMs, _longHoldDelayMs, _repeatMs);
 }
 
-bool DigitalPinSource::isActive() {
-  return bitRead(_state, 3);
+// Milliseconds until (uint16_t)(now - since) > delay
+static uint16_t _eventuinoRemainingMs(uint16_t now, uint16_t since, uint16_t delay) {
+  uint16_t elapsed = now - since;
+  return elapsed > delay ? 0 : delay - elapsed + 1;
 }
 
-void DigitalPinSource::setIsActive(bool b) {
-  bitWrite(_state, 3, b);
+uint16_t DigitalPinSource::idleTimed(uint8_t debounceDelayMs, 
+    uint16_t longHoldDelayMs, uint8_t repeatMs) {
+  // Only pins read through the HAL can report edges
+  if (_doDigitalRead != _eventuinoDigitalReadDefault) return 0;
+
+  uint16_t now = EventuinoHal::millis();
+  uint8_t mode = debounceMode();
+  if (mode == DEBOUNCE_INTEGRATOR && _history != 0x00 && _history != 0xFF) {
+    // Still sampling
+    uint8_t tick = debounceDelayMs >> 3;
+    return tick ? tick : 1;
+  } else if (mode == DEBOUNCE_EAGER || prevState() != currState()) {
+    // Locked out, or waiting for the pin to settle
+    uint16_t remaining = _eventuinoRemainingMs(now, _toggleTime, debounceDelayMs);
+    if (remaining > 0 || mode != DEBOUNCE_EAGER) return remaining;
+  }
+
+  if (isActive()) {
+    if (!isLongHold()) {
+      return _eventuinoRemainingMs(now, _toggleTime, longHoldDelayMs);
+    } else if (isRepeatEnabled()) {
+      return _eventuinoRemainingMs(now, _lastRepeat, repeatMs);
+    }
+  }
+  return 0xFFFF;
 }
 
-bool DigitalPinSource::isLongHold() {
-  return bitRead(_state, 2);
+uint8_t DigitalPinSource::inputPullupPin() {
+  return _doPinSetup == _eventuinoPinSetupDefault ? _pinNumber : NO_PIN;
 }
 
-void DigitalPinSource::setIsLongHold(bool b) {
-  bitWrite(_state, 2, b);
+void DigitalPinSource::seedState(bool notify, void* state) {
+  // A seeded begin() sets the pin up without calling setup()
+  resolveInputRegister();
+  uint8_t reading = readPin();
+  bool active = reading == EventuinoHal::LOW_STATE;
+  uint16_t now = EventuinoHal::millis();
+  // currState and prevState both the reading, long hold timed from now
+  _state = (_state & 0b11110000) | (active ? 0b1000 : 0b0011);
+  _history = active ? 0x00 : 0xFF;
+  _toggleTime = active ? now : 0;
+  _lastRepeat = active ? now : 0;
+  if (notify) onChange(_value, state);
 }
 
-uint8_t DigitalPinSource::currState() {
-  return bitRead(_state, 1);
+uint8_t DigitalPinSource::saveState(uint8_t* buffer) {
+  uint16_t elapsed = (uint16_t)EventuinoHal::millis() - _toggleTime;
+  buffer[0] = _state & 0b1111; // isActive | isLongHold | currState | prevState
+  buffer[1] = _history;
+  buffer[2] = elapsed & 0xFF;
+  buffer[3] = elapsed >> 8;
+  return snapshotMax();
 }
 
-void DigitalPinSource::setCurrState(uint8_t s) {
-  bitWrite(_state, 1, s);
+void DigitalPinSource::restoreState(const uint8_t* buffer, uint8_t length) {
+  if (length != snapshotMax()) return;
+  uint16_t now = EventuinoHal::millis();
+  _state = (_state & 0b11110000) | (buffer[0] & 0b1111);
+  _history = buffer[1];
+  _toggleTime = now - (buffer[2] | ((uint16_t)buffer[3] << 8));
+  _lastRepeat = now;
 }
 
-uint8_t DigitalPinSource::prevState() {
-  return bitRead(_state, 0);
+void DigitalPinSource::enableRepeat(bool b) {
+  bitWrite(_state, 4, b);
 }
 
-void DigitalPinSource::setPrevState(uint8_t s) {
-  bitWrite(_state, 0, s);
+void DigitalPinSource::setDebounceMode(debounceMode_t mode) {
+  _state = (_state & 0b10011111) | ((mode & 0b11) << 5);
 }
 
 DigitalPinSource::DigitalPinSource(DigitalPinSource&& other) noexcept {
@@ -129,9 +142,13 @@ DigitalPinSource::DigitalPinSource(DigitalPinSource&& other) noexcept {
   _value = other._value;
   _doDigitalRead = other._doDigitalRead;
   _doPinSetup = other._doPinSetup;
+  _inputRegister = other._inputRegister;
+  _inputMask = other._inputMask;
   _toggleTime = other._toggleTime;
   _lastRepeat = other._lastRepeat;
   _state = other._state;
+  _history = other._history;
+  _lastSample = other._lastSample;
   other.onChangeState = 0;
   other._doDigitalRead = 0;
   other._doPinSetup = 0;
@@ -144,9 +161,13 @@ DigitalPinSource& DigitalPinSource::operator=(DigitalPinSource&& other) noexcept
     _value = other._value;
     _doDigitalRead = other._doDigitalRead;
     _doPinSetup = other._doPinSetup;
+    _inputRegister = other._inputRegister;
+    _inputMask = other._inputMask;
     _toggleTime = other._toggleTime;
     _lastRepeat = other._lastRepeat;
     _state = other._state;
+    _history = other._history;
+    _lastSample = other._lastSample;
     other.onChangeState = 0;
     other._doDigitalRead = 0;
     other._doPinSetup = 0;
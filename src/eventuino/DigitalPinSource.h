@@ -25,9 +25,13 @@
 #define eventuino_DigitalPinSource_h
 
 #include "../EventSource.h"
+#include "../hal/EventuinoHal.h"
+#include "../hal/bits.h"
 
 using namespace eventuino;
 
+class Task;
+
 namespace eventuino {
 
   class DigitalPinSource: public EventSource {
@@ -57,17 +61,30 @@ namespace eventuino {
         return _value;
       }
 
-      // Standard implementation for all digital pins.
-      void setup() override {
-        _doPinSetup(_pinNumber);
-      }
+      // Standard implementation for all digital pins. Pins read through
+      // the HAL also have their input register looked up, once.
+      void setup() override;
 
       void poll(void* state = nullptr) override;
 
+      uint16_t idleMs() override;
+
+      // Takes the pin's current reading as its debounced state
+      uint8_t inputPullupPin() override;
+      void seedState(bool notify, void* state = nullptr) override;
+
+      // Saves the debounced state and how long it has been held, so an
+      // active pin is taken up again without a spurious onChange. Always
+      // writes snapshotMax() bytes.
+      uint8_t snapshotMax() override { return 4; }
+      uint8_t snapshotLayout() override { return SNAPSHOT_DIGITAL_PIN; }
+      uint8_t saveState(uint8_t* buffer) override;
+      void restoreState(const uint8_t* buffer, uint8_t length) override;
+
       /*
        * Default callback used by onChange if not overriden by a subclass
        */
-      eventuinoCallback_t onChangeState = 0;
+      EventDelegate onChangeState;
 
       /*
        * Call the onLongHold method repeatedly after an initial delay.
@@ -75,6 +92,27 @@ namespace eventuino {
        */ 
       void enableRepeat(bool b);
 
+      /*
+       * Debounce strategies, selectable per source:
+       *
+       * DEBOUNCE_STABLE     - Report a change once the pin has been steady
+       *                       for longer than the debounce delay (default)
+       * DEBOUNCE_EAGER      - Report the first edge immediately, then ignore
+       *                       the pin for the debounce delay (lockout)
+       * DEBOUNCE_INTEGRATOR - Sample the pin every 1/8 of the debounce delay
+       *                       and report a change once the last 8 samples
+       *                       agree. Samples are whole milliseconds apart
+       *                       (the delay / 8, rounded down, at least 1), so
+       *                       the delay acts as a multiple of 8ms, and at
+       *                       least 8ms.
+       */
+      enum debounceMode_t : uint8_t {
+        DEBOUNCE_STABLE = 0,
+        DEBOUNCE_EAGER,
+        DEBOUNCE_INTEGRATOR
+      };
+      void setDebounceMode(debounceMode_t mode);
+
       /*
        * Update debounce delay, long hold delay and repeat delay for 
        * ALL digital pin sources.
@@ -99,22 +137,29 @@ namespace eventuino {
 
     protected:
       // Returns true when the pin is LOW
-      bool isActive();
+      bool isActive() { return bitRead(_state, 3); }
 
       // Returns true if the pin has been LOW for more than some delay
-      bool isLongHold(); 
+      bool isLongHold() { return bitRead(_state, 2); }
 
       // Called when the pin state changes (debounced). Default implementation
-      // calls DigitalPinSource.onChangeState.
+      // calls DigitalPinSource.onChangeState, or routes the activate or
+      // deactivate event followed by the change event if it is unset.
       virtual void onChange(uint8_t value, void* state = nullptr) {
-        if (onChangeState != 0) {
-          onChangeState(value, state);
+        if (onChangeState) {
+          emit(onChangeState, value, KIND_CHANGE, state);
+          return;
         }
+        emit(0, value, isActive() ? KIND_ACTIVATE : KIND_DEACTIVATE, state);
+        emit(0, value, KIND_CHANGE, state);
       };
 
       // Called when the pin has been active for more than some delay, and
-      // possibly repeated if repeat is enabled
-      virtual void onLongHold(uint8_t value, void* state = nullptr) {};
+      // possibly repeated if repeat is enabled. Default implementation
+      // routes the long hold event.
+      virtual void onLongHold(uint8_t value, void* state = nullptr) {
+        emit(0, value, KIND_LONG_HOLD, state);
+      };
 
       // For derived class move constructors/operators
       template<typename T>
@@ -122,26 +167,86 @@ namespace eventuino {
         return static_cast<T&&>(obj);
       }
 
+      /*
+       * The debounce and long hold logic behind poll(), with the timing
+       * passed in rather than read from the static delays. Defined inline
+       * so that subclasses passing compile-time constants (see BasicButton
+       * and BasicToggle) get them folded into the comparisons.
+       */
+      inline void pollTimed(uint8_t debounceDelayMs, uint16_t longHoldDelayMs,
+          uint8_t repeatMs, void* state);
+
+      // pollTimed() for DEBOUNCE_EAGER and DEBOUNCE_INTEGRATOR
+      inline void pollTimedModes(uint8_t reading, uint8_t debounceDelayMs,
+          uint16_t longHoldDelayMs, uint8_t repeatMs, void* state);
+
+      // The idleMs() behind pollTimed()
+      uint16_t idleTimed(uint8_t debounceDelayMs, uint16_t longHoldDelayMs,
+          uint8_t repeatMs);
+
     private:
       DigitalPinSource() = delete;
 
+      template<class M> friend class DigitalPinGroup;
+      friend class ::Task;
+      friend class EventuinoTestHelper;
+
+      /*
+       * DEBOUNCE_STABLE transitions, indexed by reading (bit 2),
+       * currState (bit 1) and prevState (bit 0):
+       *
+       * TR_BOUNCE   - The reading differs from prevState; restart the
+       *               debounce delay
+       * TR_SETTLE   - The reading differs from currState; take it once
+       *               steady past the debounce delay
+       * TR_ACTIVATE - With TR_SETTLE, the new state is active (a press)
+       * TR_HOLD     - Steady and active; check for long hold and repeat
+       *
+       * 0 is a steady, released pin, which needs no timing at all.
+       */
+      enum : uint8_t {
+        TR_BOUNCE   = 0b0001,
+        TR_SETTLE   = 0b0010,
+        TR_ACTIVATE = 0b0100,
+        TR_HOLD     = 0b1000
+      };
+      static const uint8_t _transitions[8];
+
       uint8_t _pinNumber;
       uint8_t _value;
       digitalReadCallback_t _doDigitalRead;
       pinSetupCallback_t _doPinSetup;
+
+      // Where the HAL supports it, the pin's input register and bit mask,
+      // so a read is a single load instead of a digitalRead()
+      volatile uint8_t* _inputRegister = nullptr;
+      uint8_t _inputMask = 0;
       uint16_t _toggleTime = 0;
       uint16_t _lastRepeat = 0;
 
-      // bits: 000 | enableRepeat | isActive | isLongHold | currState | prevState
+      // bits: 0 | debounceMode (2) | enableRepeat | isActive | isLongHold | currState | prevState
       uint8_t _state = 0b00000011;
 
-      bool isRepeatEnabled();
-      uint8_t currState();
-      uint8_t prevState();
-      void setPrevState(uint8_t s);
-      void setCurrState(uint8_t s);
-      void setIsActive(bool b);
-      void setIsLongHold(bool b);
+      // DEBOUNCE_INTEGRATOR only: the last 8 samples (newest in bit 0) and
+      // when the last one was taken
+      uint8_t _history = 0xFF;
+      uint8_t _lastSample = 0;
+
+      void resolveInputRegister();
+      uint8_t readPin() {
+        return _inputRegister != nullptr
+            ? EventuinoHal::readInputRegister(_inputRegister, _inputMask)
+            : _doDigitalRead(_pinNumber);
+      }
+
+      uint8_t debounceMode() { return (_state >> 5) & 0b11; }
+      bool isRepeatEnabled() { return bitRead(_state, 4); }
+      uint8_t currState() { return bitRead(_state, 1); }
+      uint8_t prevState() { return bitRead(_state, 0); }
+      void setPrevState(uint8_t s) { bitWrite(_state, 0, s); }
+      void setCurrState(uint8_t s) { bitWrite(_state, 1, s); }
+      void setIsActive(bool b) { bitWrite(_state, 3, b); }
+      void setIsLongHold(bool b) { bitWrite(_state, 2, b); }
 
       static uint16_t _longHoldDelayMs;
       static uint8_t _repeatMs;
@@ -149,6 +254,128 @@ namespace eventuino {
 
   };
 
+  void DigitalPinSource::pollTimed(uint8_t debounceDelayMs, 
+      uint16_t longHoldDelayMs, uint8_t repeatMs, void* state) {
+    uint8_t reading = readPin();
+    if (debounceMode() != DEBOUNCE_STABLE) {
+      pollTimedModes(reading, debounceDelayMs, longHoldDelayMs, repeatMs, state);
+      return;
+    }
+
+    uint8_t transition = _transitions[
+        (reading == EventuinoHal::LOW_STATE ? 0 : 0b100) | (_state & 0b11)];
+    if (transition == 0) return; // steady and released, nothing to time
+
+    uint16_t now = EventuinoHal::millis(); // trunc to last 16-bits (32s)
+    if (transition & TR_BOUNCE) {
+      // Pin state has changed, but might be noise
+      _toggleTime = now;
+      _state ^= 0b01; // prevState = reading
+      return;
+    }
+    if ((uint16_t)(now - _toggleTime) <= debounceDelayMs) return;
+
+    if (transition & TR_HOLD) {
+      // Steady and active, check for long hold
+      if (((uint16_t)(now - _toggleTime) > longHoldDelayMs) &&
+          ((uint16_t)(now - _lastRepeat) > repeatMs)) {
+        // Possibly also a repeat long hold if repeat enabled
+        bool isInitialLongHold = !isLongHold();
+        setIsLongHold(true);
+        if (isInitialLongHold || isRepeatEnabled()) {
+          onLongHold(_value, state);
+          _lastRepeat = now;
+        }
+      }
+      return;
+    }
+
+    // Steady at a new state
+    _state ^= 0b10; // currState = reading
+    if (transition & TR_ACTIVATE) {
+      // State changed from inactive to active
+      _lastRepeat = now;
+      _state |= 0b1000;
+    } else {
+      // State changed from active to inactive
+      _toggleTime = 0;
+      _lastRepeat = 0;
+      _state &= ~0b1100;
+    }
+    onChange(_value, state);
+  }
+
+  void DigitalPinSource::pollTimedModes(uint8_t reading, uint8_t debounceDelayMs, 
+      uint16_t longHoldDelayMs, uint8_t repeatMs, void* state) {
+    uint16_t now = EventuinoHal::millis(); // trunc to last 16-bits (32s)
+    uint8_t mode = debounceMode();
+
+    if (mode == DEBOUNCE_EAGER) {
+      if (reading != currState()) {
+        // Take the first edge at once, unless still locked out by the last
+        if ((uint16_t)(now - _toggleTime) <= debounceDelayMs) return;
+        _toggleTime = now;
+      }
+    } else {
+      uint8_t tick = debounceDelayMs >> 3; // whole ms, so at least 8ms in all
+      if ((uint8_t)((uint8_t)now - _lastSample) >= (tick ? tick : 1)) {
+        _lastSample = now;
+        _history = (_history << 1) | (reading == EventuinoHal::LOW_STATE ? 0 : 1);
+      }
+      // Hold the current state until all 8 samples agree
+      if (_history == 0x00) {
+        reading = EventuinoHal::LOW_STATE;
+      } else if (_history == 0xFF) {
+        reading = EventuinoHal::HIGH_STATE;
+      } else {
+        reading = currState();
+      }
+      if (reading != currState()) _toggleTime = now;
+    }
+    setPrevState(reading);
+
+    // Pin state is steady, ready to check for events
+    // Start by storing the new state
+    uint8_t prevState = currState();
+    setCurrState(reading);
+
+    if (reading != prevState) {
+      // State has changed
+
+      if (reading == EventuinoHal::LOW_STATE && prevState == EventuinoHal::HIGH_STATE) {
+        // State changed from inactive to active
+        _lastRepeat = now;
+        setIsActive(true);
+      } else {
+        // State changed from active to inactive
+        if (mode != DEBOUNCE_EAGER) _toggleTime = 0; // keep the lockout
+        _lastRepeat = 0;
+        setIsActive(false);
+        setIsLongHold(false);
+      }
+      onChange(_value, state);
+
+    } else {
+      // State is unchanged, check for long hold
+
+      if (reading == EventuinoHal::LOW_STATE &&
+          ((uint16_t)(now - _toggleTime) > longHoldDelayMs) &&
+          ((uint16_t)(now - _lastRepeat) > repeatMs)) {
+        // Pin has been active long enough for long hold
+        // Possibly also a repeat long hold if repeat enabled
+
+        bool isInitialLongHold = !isLongHold();
+        setIsLongHold(true);
+        if (isInitialLongHold || isRepeatEnabled()) {
+          onLongHold(_value, state);
+          _lastRepeat = now;
+        } else {
+          // This is repeat pass, and repeat is disabled - do nothing
+        }  
+      }
+
+    }
+  }
 }
 
 #endif
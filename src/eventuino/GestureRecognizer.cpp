@@ -0,0 +1,121 @@
+#include "GestureRecognizer.h"
+#include "../hal/EventuinoHal.h"
+
+using namespace eventuino;
+
+// Phases of each button's state machine
+#define GR_IDLE    0  // released, no clicks pending
+#define GR_DOWN    1  // pressed, may become a click
+#define GR_UP      2  // released after a click, more clicks may follow
+#define GR_IGNORE  3  // held too long or part of a chord, wait for release
+
+// Inputs to each button's state machine
+#define GR_PRESS   0
+#define GR_RELEASE 1
+#define GR_TIMEOUT 2
+
+// Actions, combined with the next phase in each transition
+#define GR_STAMP   0b00000100  // remember the time
+#define GR_COUNT   0b00001000  // count a click
+#define GR_EMIT    0b00010000  // report the clicks
+#define GR_RESET   0b00100000  // forget the clicks
+
+static const uint8_t _gestureTransitions[4][3] = {
+  //  GR_PRESS               GR_RELEASE                      GR_TIMEOUT
+  { GR_DOWN | GR_STAMP,   GR_IDLE,                        GR_IDLE                          }, // GR_IDLE
+  { GR_DOWN,              GR_UP | GR_STAMP | GR_COUNT,    GR_IGNORE | GR_RESET             }, // GR_DOWN
+  { GR_DOWN | GR_STAMP,   GR_UP,                          GR_IDLE | GR_EMIT | GR_RESET     }, // GR_UP
+  { GR_IGNORE,            GR_IDLE | GR_RESET,             GR_IGNORE                        }  // GR_IGNORE
+};
+
+GestureRecognizer::~GestureRecognizer() {
+  if (_slots) delete[] _slots;
+  _slots = nullptr;
+  _slotCount = 0;
+}
+
+bool GestureRecognizer::addButton(Button* button) {
+  if (_slotCount >= 32) return false;
+  Slot* newSlots = new Slot[_slotCount + 1];
+  for (uint8_t i = 0; i < _slotCount; i++) {
+    newSlots[i] = _slots[i];
+  }
+  newSlots[_slotCount].button = button;
+  newSlots[_slotCount].state = button->isPressed() ? (0b100 | GR_IGNORE) : GR_IDLE;
+  newSlots[_slotCount].time = 0;
+
+  delete[] _slots;
+  _slots = newSlots;
+  _slotCount++;
+  return true;
+}
+
+void GestureRecognizer::poll(void* state) {
+  uint16_t now = EventuinoHal::millis(); // trunc to last 16-bits (32s)
+
+  for (uint8_t i = 0; i < _slotCount; i++) {
+    Slot& slot = _slots[i];
+    uint8_t phase = slot.state & 0b11;
+    bool pressed = slot.button->isPressed();
+
+    uint8_t input;
+    if (pressed != bitRead(slot.state, 2)) {
+      input = pressed ? GR_PRESS : GR_RELEASE;
+      bitWrite(slot.state, 2, pressed);
+    } else if ((phase == GR_DOWN || phase == GR_UP) && 
+        (uint16_t)(now - slot.time) > _clickWindowMs) {
+      input = GR_TIMEOUT;
+    } else {
+      continue;
+    }
+
+    uint8_t transition = _gestureTransitions[phase][input];
+    uint8_t clicks = (slot.state >> 3) & 0b111;
+    if (transition & GR_STAMP) slot.time = now;
+    if ((transition & GR_COUNT) && clicks < 7) clicks++;
+    if ((transition & GR_EMIT) && onClick != 0) {
+      onClick(slot.button->getValue(), clicks, state);
+    }
+    if (transition & GR_RESET) clicks = 0;
+    slot.state = (clicks << 3) | (slot.state & 0b100) | (transition & 0b11);
+
+    if (input == GR_PRESS) joinChord(i, now, state);
+  }
+
+  if (_chordMask != 0 && (uint16_t)(now - _chordTime) > _chordWindowMs) {
+    if (onChord != 0) onChord(_value, _chordMask, state);
+    _chordMask = 0;
+  }
+}
+
+// Start or join a chord if other buttons were pressed within the window
+void GestureRecognizer::joinChord(uint8_t i, uint16_t now, void* state) {
+  if (_chordMask != 0 && (uint16_t)(now - _chordTime) > _chordWindowMs) {
+    // A chord whose window passed since the last poll; report it before
+    // starting a new one
+    if (onChord != 0) onChord(_value, _chordMask, state);
+    _chordMask = 0;
+  }
+  uint32_t mask = _chordMask;
+  for (uint8_t j = 0; j < _slotCount; j++) {
+    if (j != i && (_slots[j].state & 0b11) == GR_DOWN &&
+        (uint16_t)(now - _slots[j].time) <= _chordWindowMs) {
+      mask |= (uint32_t)1 << j;
+    }
+  }
+  if (mask == 0) return;
+
+  if (_chordMask == 0) _chordTime = now;
+  _chordMask = mask | ((uint32_t)1 << i);
+  for (uint8_t j = 0; j < _slotCount; j++) {
+    if (bitRead(_chordMask, j)) {
+      // Chorded buttons report no clicks
+      _slots[j].state = (_slots[j].state & 0b100) | GR_IGNORE;
+    }
+  }
+}
+
+void GestureRecognizer::clearCallbacks() {
+  onClick = 0;
+  onChord = 0;
+}
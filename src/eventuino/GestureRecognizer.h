@@ -0,0 +1,108 @@
+/*
+
+  eventuino::GestureRecognizer.h
+
+  Recognizes multi-click (double-click, triple-click, ...) and chord
+  (several buttons pressed together) gestures on a set of Buttons,
+  without any timers or callbacks of its own on those Buttons. It only
+  watches each Button's debounced pressed state, so the Buttons' own
+  callbacks keep working as usual.
+
+  Invokes callback functions for:
+  - onClick
+  - onChord
+
+  Uses 5 bytes of global variable space per button, plus 15 bytes.
+
+  NOTE: The Buttons must still be added to Eventuino, before the
+  GestureRecognizer, so they are polled first in each cycle.
+
+  Copyright (c) 2024, Dan Mowehhuk (danmowehhuk@gmail.com)
+  All rights reserved.
+
+*/
+
+#ifndef eventuino_GestureRecognizer_h
+#define eventuino_GestureRecognizer_h
+
+#include "../EventSource.h"
+#include "Button.h"
+
+using namespace eventuino;
+
+class GestureRecognizer: public EventSource {
+
+  public:
+    // disable default constructor
+    GestureRecognizer() = delete;
+
+    /*
+     * value         - The value passed to onChord
+     * clickWindowMs - A click is a press and release within this window,
+     *                 and the next click of a multi-click must start
+     *                 within this window after the last release
+     * chordWindowMs - Buttons pressed within this window of each other
+     *                 form a chord
+     */
+    GestureRecognizer(uint8_t value, uint16_t clickWindowMs = 250, 
+        uint8_t chordWindowMs = 50): _value(value), 
+        _clickWindowMs(clickWindowMs), _chordWindowMs(chordWindowMs) {};
+
+    ~GestureRecognizer();
+
+    /*
+     * Watch a button for gestures. Bit i of a chord mask refers to the
+     * i-th button added. Returns false once 32 buttons have been added.
+     */
+    bool addButton(Button* button);
+
+    /*
+     * Called once a button's clicks have finished, with the button's
+     * value and the number of clicks (1 to 7)
+     */
+    typedef void (*clickCallback_t)(uint8_t value, uint8_t clicks, void* state);
+    clickCallback_t onClick = 0;
+
+    /*
+     * Called with the mask of buttons pressed together. Buttons that
+     * are part of a chord do not also report clicks.
+     */
+    typedef void (*chordCallback_t)(uint8_t value, uint32_t mask, void* state);
+    chordCallback_t onChord = 0;
+
+    void clearCallbacks();
+
+    // no pins to set up
+    void setup() override {};
+
+    // required by EventSource
+    void poll(void* state = nullptr) override;
+
+    // Disable moving and copying
+    GestureRecognizer(GestureRecognizer&& other) = delete;
+    GestureRecognizer& operator=(GestureRecognizer&& other) = delete;
+    GestureRecognizer(const GestureRecognizer&) = delete;
+    GestureRecognizer& operator=(const GestureRecognizer&) = delete;
+
+  private:
+    struct Slot {
+      Button* button;
+      // bits: 00 | clicks (3) | wasPressed | phase (2)
+      uint8_t state;
+      // when the last press or release was seen
+      uint16_t time;
+    };
+
+    uint8_t _value;
+    uint16_t _clickWindowMs;
+    uint8_t _chordWindowMs;
+    Slot* _slots = nullptr;
+    uint8_t _slotCount = 0;
+    uint32_t _chordMask = 0;
+    uint16_t _chordTime = 0;
+
+    void joinChord(uint8_t i, uint16_t now, void* state);
+
+};
+
+#endif
@@ -0,0 +1,106 @@
+#include "MuxScanner.h"
+#include "../hal/EventuinoHal.h"
+
+MuxScanner::MuxScanner(uint8_t analogPin, const uint8_t* addressPins,
+      uint8_t addressPinCount, uint8_t channelCount, uint8_t value):
+    EventSource(), _addressPins(addressPins), _doSelect(0), _doAnalogRead(0),
+    _analogPin(analogPin), _addressPinCount(addressPinCount > 5 ? 5 : addressPinCount),
+    _value(value) {
+  _channelCount = channelCount > 32 ? 32 : channelCount;
+  _channels = new Channel[_channelCount];
+  for (uint8_t i = 0; i < _channelCount; i++) {
+    _channels[i].reported = NO_READING;
+  }
+};
+
+MuxScanner::MuxScanner(uint8_t analogPin, uint8_t channelCount, uint8_t value,
+      selectCallback_t selectCallback, analogReadCallback_t readCallback):
+    MuxScanner(analogPin, nullptr, 0, channelCount, value) {
+  _doSelect = selectCallback;
+  _doAnalogRead = readCallback;
+};
+
+MuxScanner::~MuxScanner() {
+  delete[] _channels;
+  _channels = nullptr;
+}
+
+void MuxScanner::setup() {
+  for (uint8_t i = 0; i < _addressPinCount; i++) {
+    EventuinoHal::pinModeOutput(_addressPins[i]);
+  }
+}
+
+void MuxScanner::poll(void* state) {
+  if (_channelCount == 0) return;
+  unsigned long start = EventuinoHal::micros();
+  if (_phase == PHASE_IDLE) select(0);
+
+  // At most one full scan per poll(), however fast the conversions are
+  for (uint8_t scanned = 0; scanned < _channelCount; ) {
+    bool waiting;
+    if (_phase == PHASE_SETTLING) {
+      waiting = (uint16_t)((uint16_t)EventuinoHal::micros() - _selectTime) < _settleMicros;
+      if (!waiting) {
+        if (_doAnalogRead != 0) {
+          uint8_t channel = _channel;
+          uint16_t reading = _doAnalogRead(_analogPin);
+          select(channel + 1 < _channelCount ? channel + 1 : 0);
+          process(channel, reading, state);
+          scanned++;
+          continue;
+        }
+        EventuinoHal::analogStart(_analogPin);
+        _phase = PHASE_CONVERTING;
+      }
+    }
+    if (_phase == PHASE_CONVERTING) {
+      waiting = !EventuinoHal::analogReady();
+      if (!waiting) {
+        // Switch the mux before processing this result, so the next
+        // channel settles in the meantime
+        uint8_t channel = _channel;
+        uint16_t reading = EventuinoHal::analogResult();
+        select(channel + 1 < _channelCount ? channel + 1 : 0);
+        process(channel, reading, state);
+        scanned++;
+        continue;
+      }
+    }
+    if ((uint32_t)(EventuinoHal::micros() - start) >= _timeSliceMicros) return;
+  }
+}
+
+void MuxScanner::select(uint8_t channel) {
+  if (_doSelect != 0) {
+    _doSelect(channel);
+  } else {
+    for (uint8_t i = 0; i < _addressPinCount; i++) {
+      EventuinoHal::digitalWritePin(_addressPins[i], (channel >> i) & 0x01
+          ? EventuinoHal::HIGH_STATE : EventuinoHal::LOW_STATE);
+    }
+  }
+  _channel = channel;
+  _selectTime = EventuinoHal::micros();
+  _phase = PHASE_SETTLING;
+}
+
+void MuxScanner::process(uint8_t channel, uint16_t reading, void* state) {
+  Channel& c = _channels[channel];
+  int32_t scaled = (int32_t)reading << 4;
+  if (c.reported == NO_READING) {
+    c.filtered = scaled;
+  } else {
+    c.filtered = c.filtered + ((scaled - (int32_t)c.filtered) >> _filterShift);
+  }
+  // Readings may use all 16 bits (e.g. an external ADC), but the top
+  // value is NO_READING
+  uint32_t rounded = (c.filtered + 8) >> 4;
+  uint16_t filtered = rounded < NO_READING ? rounded : NO_READING - 1;
+  if (c.reported != NO_READING) {
+    uint16_t change = filtered > c.reported ? filtered - c.reported : c.reported - filtered;
+    if (change < _threshold || change == 0) return;
+  }
+  c.reported = filtered;
+  if (onChannelChange != 0) onChannelChange(_value, channel, filtered, state);
+}
@@ -0,0 +1,158 @@
+/*
+
+  eventuino::MuxScanner.h
+
+  Scans analog inputs, such as potentiometers, behind an analog
+  multiplexer (e.g. CD74HC4067 or CD4051). The scanner drives the mux's
+  address lines and reads each channel through one analog pin in turn,
+  without ever blocking on a conversion: poll() starts a conversion and
+  returns, and a later poll() picks up the result. Each result is read
+  only after the next channel has been selected, so that channel's
+  settling time overlaps with filtering and dispatching the previous
+  one. With setTimeSliceMicros(...), a poll() may instead keep scanning,
+  waiting on conversions, for up to the given time.
+
+  Each channel's readings pass through an exponential moving average,
+  and onChannelChange is invoked only when the filtered reading moves by
+  at least the threshold from the last one reported, so ADC noise on an
+  untouched knob doesn't produce events.
+
+  Up to 32 channels are supported, e.g. two 16-channel muxes sharing
+  address lines, with a 5th line switching between their enable pins.
+
+  Invokes callback functions for:
+  - onChannelChange
+
+  Uses 6 bytes per channel, plus 26 bytes.
+
+  Copyright (c) 2024, Dan Mowehhuk (danmowehhuk@gmail.com)
+  All rights reserved.
+
+*/
+
+#ifndef eventuino_MuxScanner_h
+#define eventuino_MuxScanner_h
+
+#include "../EventSource.h"
+
+using namespace eventuino;
+
+class MuxScanner: public EventSource {
+
+  public:
+    // disable default constructor
+    MuxScanner() = delete;
+
+    /*
+     * Constructor using the HAL to drive the address lines and the ADC
+     *
+     * analogPin        - The pin wired to the mux's common output
+     * addressPins      - The address lines, least significant first. The
+     *                    array is not copied and must outlive the scanner.
+     * addressPinCount  - Number of address lines (up to 5)
+     * channelCount     - Channels to scan, from 0 (up to 32)
+     * value            - The value passed to onChannelChange
+     */
+    MuxScanner(uint8_t analogPin, const uint8_t* addressPins,
+        uint8_t addressPinCount, uint8_t channelCount, uint8_t value);
+
+    /*
+     * Constructor using custom callbacks, e.g. for address lines on a
+     * shift register or an external ADC. The read callback converts
+     * synchronously, so there's nothing to overlap it with.
+     */
+    typedef void (*selectCallback_t)(uint8_t channel);
+    typedef uint16_t (*analogReadCallback_t)(uint8_t analogPin);
+    MuxScanner(uint8_t analogPin, uint8_t channelCount, uint8_t value,
+        selectCallback_t selectCallback, analogReadCallback_t readCallback);
+
+    ~MuxScanner();
+
+    /*
+     * Called with a channel's filtered reading whenever it moves by at
+     * least the threshold, including each channel's first reading
+     */
+    typedef void (*channelCallback_t)(uint8_t value, uint8_t channel,
+        uint16_t reading, void* state);
+    channelCallback_t onChannelChange = 0;
+
+    // Time to let the mux output settle after switching channels
+    // (default 10us)
+    void setSettleMicros(uint8_t micros) {
+      _settleMicros = micros;
+    }
+
+    // Longest a poll() may wait on settling and conversions to scan
+    // further (default 0: never wait, scan only what's ready)
+    void setTimeSliceMicros(uint16_t micros) {
+      _timeSliceMicros = micros;
+    }
+
+    // Averages over roughly 2^shift readings; 0 disables filtering
+    // (default 2, at most 4)
+    void setFilter(uint8_t shift) {
+      _filterShift = shift > 4 ? 4 : shift;
+    }
+
+    // Smallest change in the filtered reading reported (default 4)
+    void setThreshold(uint16_t threshold) {
+      _threshold = threshold;
+    }
+
+    // The channel's last reported reading, or NO_READING before its first.
+    // A full-scale 16-bit reading is reported as NO_READING - 1.
+    uint16_t getReading(uint8_t channel) {
+      return channel < _channelCount ? _channels[channel].reported : NO_READING;
+    }
+    static const uint16_t NO_READING = 0xFFFF;
+
+    uint8_t getValue() {
+      return _value;
+    }
+
+    void setup() override;
+    void poll(void* state = nullptr) override;
+    uint16_t idleMs() override {
+      return 0;
+    }
+
+    // Disable moving and copying
+    MuxScanner(MuxScanner&& other) = delete;
+    MuxScanner& operator=(MuxScanner&& other) = delete;
+    MuxScanner(const MuxScanner&) = delete;
+    MuxScanner& operator=(const MuxScanner&) = delete;
+
+  private:
+    enum phase_t : uint8_t {
+      PHASE_IDLE = 0,
+      PHASE_SETTLING,
+      PHASE_CONVERTING
+    };
+
+    struct Channel {
+      uint32_t filtered;  // scaled by 16 for fractional precision
+      uint16_t reported;
+    };
+
+    void select(uint8_t channel);
+    void process(uint8_t channel, uint16_t reading, void* state);
+
+    const uint8_t* _addressPins;
+    selectCallback_t _doSelect;
+    analogReadCallback_t _doAnalogRead;
+    Channel* _channels;
+    uint16_t _threshold = 4;
+    uint16_t _timeSliceMicros = 0;
+    uint16_t _selectTime = 0;
+    uint8_t _analogPin;
+    uint8_t _addressPinCount;
+    uint8_t _channelCount;
+    uint8_t _value;
+    uint8_t _channel = 0;
+    uint8_t _settleMicros = 10;
+    uint8_t _filterShift = 2;
+    phase_t _phase = PHASE_IDLE;
+
+};
+
+#endif
@@ -0,0 +1,154 @@
+#include "Output.h"
+#include "../hal/EventuinoHal.h"
+
+void BlinkPattern::setup() {
+  EventuinoHal::pinModeOutput(_pin);
+  write(false);
+}
+
+void BlinkPattern::start(const uint8_t* steps, uint8_t count, uint8_t flash) {
+  _steps = steps;
+  _flags = (_flags & FLAG_ACTIVE_LOW) | flash | FLAG_PLAYING;
+  _remaining = count == 0 ? 0xFF : count - 1;
+  _index = 0;
+  _stepStart = EventuinoHal::millis();
+  uint8_t step = stepAt(0);
+  if (step == BLINK_END) {
+    stop();
+    return;
+  }
+  write(step & 0x80);
+}
+
+void BlinkPattern::stop() {
+  _flags &= ~FLAG_PLAYING;
+  write(false);
+}
+
+void BlinkPattern::poll(void* state) {
+  if (!(_flags & FLAG_PLAYING)) return;
+  uint16_t now = EventuinoHal::millis();
+  uint16_t durationMs = (stepAt(_index) & 0x7F) * 10;
+  if ((uint16_t)(now - _stepStart) < durationMs) return;
+
+  uint8_t step = stepAt(++_index);
+  if (step == BLINK_END) {
+    if (_remaining == 0) {
+      stop();
+      emit(onFinished, _value, KIND_EXPIRE, state);
+      return;
+    }
+    if (_remaining != 0xFF) _remaining--;
+    _index = 0;
+    step = stepAt(0);
+  }
+  // Keep to the pattern's timing, unless this poll came so late that
+  // the new step would be over too
+  _stepStart += durationMs;
+  if ((uint16_t)(now - _stepStart) >= (step & 0x7F) * 10) _stepStart = now;
+  write(step & 0x80);
+}
+
+uint16_t BlinkPattern::idleMs() {
+  if (!(_flags & FLAG_PLAYING)) return 0xFFFF;
+  uint16_t durationMs = (stepAt(_index) & 0x7F) * 10;
+  uint16_t elapsed = (uint16_t)EventuinoHal::millis() - _stepStart;
+  return elapsed < durationMs ? durationMs - elapsed : 0;
+}
+
+uint8_t BlinkPattern::stepAt(uint8_t index) {
+  if (_flags & FLAG_FLASH) return EventuinoHal::readFlashByte(_steps + index);
+  return _steps[index];
+}
+
+void BlinkPattern::write(bool active) {
+  bool high = active != ((_flags & FLAG_ACTIVE_LOW) != 0);
+  EventuinoHal::digitalWritePin(_pin, high ? EventuinoHal::HIGH_STATE : EventuinoHal::LOW_STATE);
+}
+
+void PulseOutput::setup() {
+  EventuinoHal::pinModeOutput(_pin);
+  EventuinoHal::digitalWritePin(_pin, _activeLow ? EventuinoHal::HIGH_STATE : EventuinoHal::LOW_STATE);
+}
+
+void PulseOutput::pulse(uint16_t ms) {
+  _start = EventuinoHal::millis();
+  _durationMs = ms;
+  if (!_active) {
+    _active = true;
+    EventuinoHal::digitalWritePin(_pin, _activeLow ? EventuinoHal::LOW_STATE : EventuinoHal::HIGH_STATE);
+  }
+}
+
+void PulseOutput::poll(void*) {
+  if (!_active) return;
+  if ((uint16_t)((uint16_t)EventuinoHal::millis() - _start) < _durationMs) return;
+  _active = false;
+  EventuinoHal::digitalWritePin(_pin, _activeLow ? EventuinoHal::HIGH_STATE : EventuinoHal::LOW_STATE);
+}
+
+uint16_t PulseOutput::idleMs() {
+  if (!_active) return 0xFFFF;
+  uint16_t elapsed = (uint16_t)EventuinoHal::millis() - _start;
+  return elapsed < _durationMs ? _durationMs - elapsed : 0;
+}
+
+SoftPwm::SoftPwm(const uint8_t* pins, uint8_t pinCount, uint16_t periodMicros,
+      bool activeLow):
+    EventSource(), _pins(pins), _periodMicros(periodMicros == 0 ? 1 : periodMicros),
+    _pinCount(pinCount > 8 ? 8 : pinCount), _activeLow(activeLow) {
+  _onMicros = new uint16_t[_pinCount];
+  for (uint8_t i = 0; i < _pinCount; i++) {
+    _onMicros[i] = 0;
+  }
+};
+
+SoftPwm::~SoftPwm() {
+  delete[] _onMicros;
+  _onMicros = nullptr;
+}
+
+void SoftPwm::setDuty(uint8_t i, uint8_t duty) {
+  if (i >= _pinCount) return;
+  _onMicros[i] = duty == 255 ? _periodMicros : ((uint32_t)duty * _periodMicros) >> 8;
+}
+
+void SoftPwm::setup() {
+  for (uint8_t i = 0; i < _pinCount; i++) {
+    EventuinoHal::pinModeOutput(_pins[i]);
+  }
+  _levels = 0;
+  EventuinoHal::digitalWritePins(_pins, _pinCount, _activeLow ? 0xFF : 0, 0xFF);
+  _periodStart = EventuinoHal::micros();
+}
+
+void SoftPwm::poll(void*) {
+  uint16_t elapsed = (uint16_t)EventuinoHal::micros() - _periodStart;
+  if (elapsed >= _periodMicros) {
+    // Start the cycle this poll falls in
+    uint16_t periods = elapsed / _periodMicros;
+    _periodStart += periods * _periodMicros;
+    elapsed -= periods * _periodMicros;
+  }
+  uint8_t levels = 0;
+  for (uint8_t i = 0; i < _pinCount; i++) {
+    if (elapsed < _onMicros[i]) levels |= 1 << i;
+  }
+  uint8_t changed = levels ^ _levels;
+  if (changed == 0) return;
+  _levels = levels;
+  EventuinoHal::digitalWritePins(_pins, _pinCount, _activeLow ? ~levels : levels, changed);
+}
+
+uint16_t SoftPwm::idleMs() {
+  // Steady once every pin is fully on or off
+  uint8_t steady = 0;
+  for (uint8_t i = 0; i < _pinCount; i++) {
+    if (_onMicros[i] == _periodMicros) {
+      steady |= 1 << i;
+    } else if (_onMicros[i] != 0) {
+      return 0;
+    }
+  }
+  return _levels == steady ? 0xFFFF : 0;
+}
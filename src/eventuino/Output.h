@@ -0,0 +1,199 @@
+/*
+
+  eventuino::Output.h
+
+  Output pins driven from Eventuino::poll(), for feedback LEDs, buzzers
+  and the like, without delay() or a Timer and callback per output.
+  Added to Eventuino like any other source; each poll() only checks the
+  time and writes a pin when its level is due to change.
+
+  Use one of the following output classes:
+  - BlinkPattern: 15 bytes, plays a table of on/off steps
+  - PulseOutput:  9 bytes, a single retriggerable pulse
+  - SoftPwm:      2 bytes per pin, plus 13 bytes. Software PWM on up to
+                  8 pins, for dimming LEDs (not for servos; the edges
+                  jitter by as much as the time between polls)
+
+  Outputs are "active" at HIGH unless constructed with activeLow = true,
+  e.g. for an LED wired between the pin and Vcc.
+
+  Copyright (c) 2024, Dan Mowehhuk (danmowehhuk@gmail.com)
+  All rights reserved.
+
+*/
+
+#ifndef eventuino_Output_h
+#define eventuino_Output_h
+
+#include "../EventSource.h"
+
+using namespace eventuino;
+
+/*
+ * BlinkPattern steps are one byte each: whether the output is active,
+ * and for how long, in 10ms units from 10 to 1270ms. A pattern ends with
+ * BLINK_END. For example, two short blinks and a pause:
+ *
+ *   const uint8_t twoBlinks[] PROGMEM = {
+ *     BLINK_ON(100), BLINK_OFF(100), BLINK_ON(100), BLINK_OFF(700), BLINK_END
+ *   };
+ */
+#define BLINK_ON(ms) ((uint8_t)(0x80 | ((ms) / 10)))
+#define BLINK_OFF(ms) ((uint8_t)((ms) / 10))
+#define BLINK_END ((uint8_t)0)
+
+class BlinkPattern: public EventSource {
+
+  public:
+    // disable default constructor
+    BlinkPattern() = delete;
+
+    /*
+     * pin       - The output pin
+     * value     - The value passed to onFinished
+     * activeLow - Drive the pin LOW when the pattern is on
+     */
+    BlinkPattern(uint8_t pin, uint8_t value, bool activeLow = false):
+        EventSource(), _pin(pin), _value(value),
+        _flags(activeLow ? FLAG_ACTIVE_LOW : 0) {};
+
+    /*
+     * Called when a pattern played a limited number of times has ended
+     */
+    EventDelegate onFinished;
+
+    /*
+     * Starts playing the steps from the beginning, count times over, or
+     * until stop() if count is 0. playFlash() reads steps placed in
+     * flash with PROGMEM. The steps are not copied.
+     */
+    void play(const uint8_t* steps, uint8_t count = 0) {
+      start(steps, count, 0);
+    }
+    void playFlash(const uint8_t* steps, uint8_t count = 0) {
+      start(steps, count, FLAG_FLASH);
+    }
+
+    // Stops playing, leaving the output inactive, without onFinished
+    void stop();
+
+    bool isPlaying() {
+      return _flags & FLAG_PLAYING;
+    }
+
+    uint8_t getValue() {
+      return _value;
+    }
+
+    void setup() override;
+    void poll(void* state = nullptr) override;
+    uint16_t idleMs() override;
+
+    // Disable moving and copying
+    BlinkPattern(BlinkPattern&& other) = delete;
+    BlinkPattern& operator=(BlinkPattern&& other) = delete;
+    BlinkPattern(const BlinkPattern&) = delete;
+    BlinkPattern& operator=(const BlinkPattern&) = delete;
+
+  private:
+    static const uint8_t FLAG_PLAYING = 0x01;
+    static const uint8_t FLAG_FLASH = 0x02;
+    static const uint8_t FLAG_ACTIVE_LOW = 0x04;
+
+    void start(const uint8_t* steps, uint8_t count, uint8_t flash);
+    uint8_t stepAt(uint8_t index);
+    void write(bool active);
+
+    const uint8_t* _steps = nullptr;
+    uint16_t _stepStart = 0;
+    uint8_t _pin;
+    uint8_t _value;
+    uint8_t _index = 0;
+    uint8_t _remaining = 0;  // plays left after this one, or 0xFF forever
+    uint8_t _flags;
+
+};
+
+class PulseOutput: public EventSource {
+
+  public:
+    // disable default constructor
+    PulseOutput() = delete;
+
+    /*
+     * pin       - The output pin
+     * activeLow - Drive the pin LOW for the pulse
+     */
+    PulseOutput(uint8_t pin, bool activeLow = false):
+        EventSource(), _pin(pin), _activeLow(activeLow) {};
+
+    // Makes the output active for ms milliseconds from now, extending
+    // any pulse already in progress
+    void pulse(uint16_t ms);
+
+    bool isActive() {
+      return _active;
+    }
+
+    void setup() override;
+    void poll(void* state = nullptr) override;
+    uint16_t idleMs() override;
+
+    // Disable moving and copying
+    PulseOutput(PulseOutput&& other) = delete;
+    PulseOutput& operator=(PulseOutput&& other) = delete;
+    PulseOutput(const PulseOutput&) = delete;
+    PulseOutput& operator=(const PulseOutput&) = delete;
+
+  private:
+    uint16_t _start = 0;
+    uint16_t _durationMs = 0;
+    uint8_t _pin;
+    bool _activeLow;
+    bool _active = false;
+
+};
+
+class SoftPwm: public EventSource {
+
+  public:
+    // disable default constructor
+    SoftPwm() = delete;
+
+    /*
+     * pins         - The output pins (up to 8). The array is not copied
+     *                and must outlive the SoftPwm.
+     * pinCount     - Number of pins
+     * periodMicros - Length of one PWM cycle; the default 10ms (100Hz)
+     *                is flicker-free as long as polls are frequent
+     * activeLow    - Drive the pins LOW for the "on" part of the cycle
+     */
+    SoftPwm(const uint8_t* pins, uint8_t pinCount, uint16_t periodMicros = 10000,
+        bool activeLow = false);
+    ~SoftPwm();
+
+    // Sets pin i's duty cycle, from 0 (always off) to 255 (always on)
+    void setDuty(uint8_t i, uint8_t duty);
+
+    void setup() override;
+    void poll(void* state = nullptr) override;
+    uint16_t idleMs() override;
+
+    // Disable moving and copying
+    SoftPwm(SoftPwm&& other) = delete;
+    SoftPwm& operator=(SoftPwm&& other) = delete;
+    SoftPwm(const SoftPwm&) = delete;
+    SoftPwm& operator=(const SoftPwm&) = delete;
+
+  private:
+    const uint8_t* _pins;
+    uint16_t* _onMicros;  // per pin, within each period
+    uint16_t _periodMicros;
+    uint16_t _periodStart = 0;
+    uint8_t _pinCount;
+    uint8_t _levels = 0;  // bit i: pin i currently on
+    bool _activeLow;
+
+};
+
+#endif
@@ -0,0 +1,119 @@
+#include "PositionSelector.h"
+#include "../hal/EventuinoHal.h"
+
+static void _eventuinoSelectorSetupDefault(uint8_t pinNumber) {
+  EventuinoHal::pinModeInputPullup(pinNumber);
+}
+
+static uint16_t _eventuinoBitfieldReadDefault(const uint8_t* pins, uint8_t pinCount) {
+  uint16_t bits = 0;
+  for (uint8_t i = 0; i < pinCount; i++) {
+    if (EventuinoHal::digitalReadPin(pins[i]) == EventuinoHal::LOW_STATE) {
+      bits |= (uint16_t)1 << i;
+    }
+  }
+  return bits;
+}
+
+PositionSelector::PositionSelector(const uint8_t* pins, uint8_t pinCount,
+      uint8_t value, encoding_t encoding, uint8_t debounceDelayMs):
+    PositionSelector(pins, pinCount, value, encoding, debounceDelayMs,
+        _eventuinoSelectorSetupDefault, _eventuinoBitfieldReadDefault) {};
+
+PositionSelector::PositionSelector(const uint8_t* pins, uint8_t pinCount,
+      uint8_t value, encoding_t encoding, uint8_t debounceDelayMs,
+      DigitalPinSource::pinSetupCallback_t setupCallback,
+      bitfieldReadCallback_t readCallback):
+    EventSource(), _pins(pins), _doPinSetup(setupCallback),
+    _doBitfieldRead(readCallback), _pinCount(pinCount > 16 ? 16 : pinCount),
+    _value(value), _encoding(encoding), _debounceDelayMs(debounceDelayMs) {};
+
+void PositionSelector::setup() {
+  for (uint8_t i = 0; i < _pinCount; i++) {
+    _doPinSetup(_pins[i]);
+  }
+}
+
+void PositionSelector::poll(void* state) {
+  uint16_t now = EventuinoHal::millis();
+  uint16_t bits = _doBitfieldRead(_pins, _pinCount);
+  if (bits != _lastBits) {
+    // Contacts are moving, might be passing through other positions
+    _toggleTime = now;
+    _lastBits = bits;
+    return;
+  }
+  if ((uint16_t)(now - _toggleTime) <= _debounceDelayMs) return;
+
+  uint16_t position = decode(bits, _encoding);
+  if (position == NO_POSITION || position == _position) return;
+  _position = position;
+  if (onPosition != 0) onPosition(_value, (uint8_t)position, state);
+}
+
+void PositionSelector::seedState(bool notify, void* state) {
+  // As if the contacts had been still for the whole debounce delay
+  _lastBits = _doBitfieldRead(_pins, _pinCount);
+  _toggleTime = (uint16_t)EventuinoHal::millis() - _debounceDelayMs - 1;
+  _position = decode(_lastBits, _encoding);
+  if (notify && _position != NO_POSITION && onPosition != 0) {
+    onPosition(_value, (uint8_t)_position, state);
+  }
+}
+
+uint8_t PositionSelector::saveState(uint8_t* buffer) {
+  uint16_t elapsed = (uint16_t)EventuinoHal::millis() - _toggleTime;
+  buffer[0] = _position & 0xFF;
+  buffer[1] = _position >> 8;
+  buffer[2] = _lastBits & 0xFF;
+  buffer[3] = _lastBits >> 8;
+  buffer[4] = elapsed & 0xFF;
+  buffer[5] = elapsed >> 8;
+  return 6;
+}
+
+void PositionSelector::restoreState(const uint8_t* buffer, uint8_t length) {
+  if (length != 6) return;
+  _position = buffer[0] | ((uint16_t)buffer[1] << 8);
+  _lastBits = buffer[2] | ((uint16_t)buffer[3] << 8);
+  _toggleTime = (uint16_t)EventuinoHal::millis() - (buffer[4] | ((uint16_t)buffer[5] << 8));
+}
+
+uint16_t PositionSelector::idleMs() {
+  // Only pins read through the HAL can report edges
+  if (_doBitfieldRead != _eventuinoBitfieldReadDefault) return 0;
+  uint16_t elapsed = (uint16_t)EventuinoHal::millis() - _toggleTime;
+  if (elapsed > _debounceDelayMs) {
+    // Settled, unless there's a new position still to report
+    uint16_t position = decode(_lastBits, _encoding);
+    return position == NO_POSITION || position == _position ? 0xFFFF : 0;
+  }
+  return _debounceDelayMs - elapsed + 1;
+}
+
+uint16_t PositionSelector::decode(uint16_t bits, encoding_t encoding) {
+  switch (encoding) {
+    case ENCODING_ONE_HOT: {
+      // Exactly one bit set
+      if (bits == 0 || (bits & (bits - 1)) != 0) return NO_POSITION;
+      uint8_t position = 0;
+      while (bits >>= 1) position++;
+      return position;
+    }
+    case ENCODING_BCD: {
+      uint8_t ones = bits & 0x0F;
+      uint8_t tens = (bits >> 4) & 0x0F;
+      if (ones > 9 || tens > 9 || (bits >> 8) != 0) return NO_POSITION;
+      return tens * 10 + ones;
+    }
+    case ENCODING_GRAY: {
+      uint8_t position = bits;
+      for (uint8_t shift = 1; shift < 8; shift <<= 1) {
+        position ^= position >> shift;
+      }
+      return (bits >> 8) != 0 ? NO_POSITION : position;
+    }
+    default:
+      return (bits >> 8) != 0 ? NO_POSITION : bits;
+  }
+}
@@ -0,0 +1,130 @@
+/*
+
+  eventuino::PositionSelector.h
+
+  A multi-position selector, such as a rotary switch, read from several
+  pins at once as one bitfield. The combined position is debounced as a
+  single value, so turning the selector reports one onPosition event
+  with the final position, rather than a change per pin and glitches
+  while the contacts move.
+
+  The pins are decoded as one of:
+  - ENCODING_ONE_HOT: one pin per position (pin i active = position i)
+  - ENCODING_BINARY:  pin i is bit i of the position
+  - ENCODING_BCD:     pins 0-3 are the ones digit, pins 4-7 the tens
+  - ENCODING_GRAY:    pin i is bit i of the Gray-coded position
+
+  As with DigitalPinSource, a pin is "active" (a 1 bit) when it reads
+  LOW. Bitfields that aren't a valid position, such as no or several
+  one-hot pins at once, or a BCD digit over 9, are ignored.
+
+  Invokes callback functions for:
+  - onPosition
+
+  Uses 20 bytes of global variable space.
+
+  Copyright (c) 2024, Dan Mowehhuk (danmowehhuk@gmail.com)
+  All rights reserved.
+
+*/
+
+#ifndef eventuino_PositionSelector_h
+#define eventuino_PositionSelector_h
+
+#include "../EventSource.h"
+#include "DigitalPinSource.h"
+
+using namespace eventuino;
+
+class PositionSelector: public EventSource {
+
+  public:
+    enum encoding_t : uint8_t {
+      ENCODING_ONE_HOT = 0,
+      ENCODING_BINARY,
+      ENCODING_BCD,
+      ENCODING_GRAY
+    };
+
+    // disable default constructor
+    PositionSelector() = delete;
+
+    /*
+     * Constructor using the HAL to set up and read the pins
+     *
+     * pins            - The selector's pins, least significant first (up
+     *                   to 16, or 8 for binary and Gray codes). The array
+     *                   is not copied and must outlive the selector.
+     * pinCount        - Number of pins
+     * value           - The value passed to onPosition
+     * encoding        - How the pins encode the position
+     * debounceDelayMs - How long the combined pins must be steady
+     */
+    PositionSelector(const uint8_t* pins, uint8_t pinCount, uint8_t value,
+        encoding_t encoding, uint8_t debounceDelayMs = 75);
+
+    /*
+     * Constructor using custom callbacks, e.g. to read all the pins
+     * with one port register read. The read callback returns the pins
+     * as a bitfield, bit i set when the i-th pin is active (LOW).
+     */
+    typedef uint16_t (*bitfieldReadCallback_t)(const uint8_t* pins, uint8_t pinCount);
+    PositionSelector(const uint8_t* pins, uint8_t pinCount, uint8_t value,
+        encoding_t encoding, uint8_t debounceDelayMs,
+        DigitalPinSource::pinSetupCallback_t setupCallback,
+        bitfieldReadCallback_t readCallback);
+
+    /*
+     * Called with the new position once the pins have settled on it,
+     * including the first position read after startup
+     */
+    typedef void (*positionCallback_t)(uint8_t value, uint8_t position, void* state);
+    positionCallback_t onPosition = 0;
+
+    // The debounced position, or NO_POSITION before the first one.
+    // Positions fit in 8 bits; NO_POSITION is outside that range, so an
+    // 8-pin binary or Gray selector can report its last position, 255.
+    uint16_t getPosition() {
+      return _position;
+    }
+    static const uint16_t NO_POSITION = 0xFFFF;
+
+    uint8_t getValue() {
+      return _value;
+    }
+
+    void setup() override;
+    void poll(void* state = nullptr) override;
+    uint16_t idleMs() override;
+    void seedState(bool notify, void* state = nullptr) override;
+
+    // Saves the position and the contacts' debounce, so a warm restart
+    // doesn't report the position again
+    uint8_t snapshotLayout() override { return SNAPSHOT_POSITION_SELECTOR; }
+    uint8_t saveState(uint8_t* buffer) override;
+    void restoreState(const uint8_t* buffer, uint8_t length) override;
+
+    // Decodes a bitfield, returning NO_POSITION if it isn't valid
+    static uint16_t decode(uint16_t bits, encoding_t encoding);
+
+    // Disable moving and copying
+    PositionSelector(PositionSelector&& other) = delete;
+    PositionSelector& operator=(PositionSelector&& other) = delete;
+    PositionSelector(const PositionSelector&) = delete;
+    PositionSelector& operator=(const PositionSelector&) = delete;
+
+  private:
+    const uint8_t* _pins;
+    DigitalPinSource::pinSetupCallback_t _doPinSetup;
+    bitfieldReadCallback_t _doBitfieldRead;
+    uint16_t _lastBits = 0;
+    uint16_t _toggleTime = 0;
+    uint8_t _pinCount;
+    uint8_t _value;
+    encoding_t _encoding;
+    uint8_t _debounceDelayMs;
+    uint16_t _position = NO_POSITION;
+
+};
+
+#endif
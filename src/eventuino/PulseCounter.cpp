@@ -0,0 +1,87 @@
+#include "PulseCounter.h"
+#include "../hal/EventuinoHal.h"
+
+// Edge timestamps wrap every 2^32us, about 71 minutes, so a span may
+// have wrapped if the reports it runs between are further apart than
+// this, less time for the edge to precede its report
+static const uint32_t _eventuinoPulseSpanLimitMs = 4200000;
+
+PulseCounter::PulseCounter(uint16_t reportMs, uint8_t value):
+    EventSource(), _reportMs(reportMs), _value(value) {};
+
+void PulseCounter::edgeFromIsr() {
+  edgeFromIsr(EventuinoHal::micros());
+}
+
+void PulseCounter::edgeFromIsr(uint32_t timestampMicros) {
+  // Already atomic inside an AVR ISR, but not elsewhere (e.g. a thread)
+  uint8_t saved = EventuinoHal::enterCriticalFromIsr();
+  _count = _count + 1;
+  _lastEdge = timestampMicros;
+  EventuinoHal::exitCriticalFromIsr(saved);
+}
+
+uint32_t PulseCounter::getTotalCount() {
+  uint8_t saved = EventuinoHal::enterCritical();
+  uint32_t count = _count;
+  EventuinoHal::exitCritical(saved);
+  return count;
+}
+
+void PulseCounter::setup() {
+  _reportedCount = getTotalCount();
+  _nextReport = (uint16_t)EventuinoHal::millis() + _reportMs;
+}
+
+void PulseCounter::poll(void* state) {
+  uint32_t nowMs = EventuinoHal::millis();
+  uint16_t now = nowMs;
+  if (_reportMs > 0) {
+    if ((int16_t)(now - _nextReport) < 0) return;
+    // On schedule, unless polled more than an interval late
+    _nextReport += _reportMs;
+    if ((int16_t)(now - _nextReport) >= 0) _nextReport = now + _reportMs;
+  }
+
+  uint8_t saved = EventuinoHal::enterCritical();
+  uint32_t total = _count;
+  uint32_t lastEdge = _lastEdge;
+  EventuinoHal::exitCritical(saved);
+
+  uint32_t count = total - _reportedCount;
+  if (count == 0) return;
+  bool spanKnown = _hasReportedEdge && nowMs - _reportedMs < _eventuinoPulseSpanLimitMs;
+  uint32_t span = spanKnown ? lastEdge - _reportedEdge : 0;
+  _reportedCount = total;
+  _reportedEdge = lastEdge;
+  _reportedMs = nowMs;
+  _hasReportedEdge = true;
+  if (onCount != 0) onCount(_value, count, span, state);
+}
+
+uint16_t PulseCounter::idleMs() {
+  if (_reportMs == 0) return 0;
+  int16_t remaining = (int16_t)(_nextReport - (uint16_t)EventuinoHal::millis());
+  return remaining > 0 ? remaining : 0;
+}
+
+uint32_t PulseCounter::frequencyMilliHz(uint32_t count, uint32_t spanMicros) {
+  if (spanMicros == 0) return 0;
+  // count * 10^9 / spanMicros, by long division to stay in 32 bits. Each
+  // digit multiplies the remainder, up to the divisor, by 10, so a span
+  // over about 429s is divided in milliseconds instead (within 2ppm).
+  uint32_t divisor = spanMicros;
+  uint8_t digits = 9;
+  if (spanMicros > 0xFFFFFFFF / 10) {
+    divisor = (spanMicros + 500) / 1000;
+    digits = 6;
+  }
+  uint32_t quotient = count / divisor;
+  uint32_t remainder = count % divisor;
+  for (uint8_t i = 0; i < digits; i++) {
+    remainder *= 10;
+    quotient = quotient * 10 + remainder / divisor;
+    remainder %= divisor;
+  }
+  return quotient;
+}
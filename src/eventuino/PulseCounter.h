@@ -0,0 +1,113 @@
+/*
+
+  eventuino::PulseCounter.h
+
+  Counts edges of a signal too fast to poll, such as a tachometer or a
+  flow meter, and reports the count at a fixed interval. An interrupt
+  handler calls edgeFromIsr() on each edge, which only bumps a counter
+  and timestamps the edge; poll() hands the edges counted since the last
+  report to onCount, so the per-poll cost is a clock check.
+
+  Each report also gives the time spanned by its edges, measured from
+  edge to edge rather than over the report interval, so the frequency
+  (count / span) stays exact however late the loop polls. Use
+  frequencyMilliHz(...) to convert. After the signal idles, e.g. a flow
+  meter with the flow shut off, the first report once it resumes spans
+  the idle time too, so its frequency is the average since the last
+  edge before it.
+
+  Invokes callback functions for:
+  - onCount
+
+  Uses 30 bytes.
+
+  Copyright (c) 2024, Dan Mowehhuk (danmowehhuk@gmail.com)
+  All rights reserved.
+
+*/
+
+#ifndef eventuino_PulseCounter_h
+#define eventuino_PulseCounter_h
+
+#include "../EventSource.h"
+
+using namespace eventuino;
+
+class PulseCounter: public EventSource {
+
+  public:
+    // disable default constructor
+    PulseCounter() = delete;
+
+    /*
+     * reportMs - Time between reports. 0 reports as soon as edges have
+     *            been counted, at the next poll().
+     * value    - The value passed to onCount
+     */
+    PulseCounter(uint16_t reportMs, uint8_t value);
+
+    /*
+     * Called each report interval, if edges were counted.
+     *
+     * count      - Edges since the last report
+     * spanMicros - Time from the last edge of the previous report to the
+     *              last edge of this one, or 0 for the first report or
+     *              one over 70 minutes after the last, which the
+     *              timestamps can't span
+     */
+    typedef void (*countCallback_t)(uint8_t value, uint32_t count,
+        uint32_t spanMicros, void* state);
+    countCallback_t onCount = 0;
+
+    /*
+     * Counts an edge, from an interrupt handler, timestamped with the
+     * HAL's micros()
+     */
+    void edgeFromIsr();
+
+    /*
+     * Counts an edge, from an interrupt handler, with a timestamp in
+     * microseconds taken by the hardware, e.g. converted from a timer's
+     * input capture register
+     */
+    void edgeFromIsr(uint32_t timestampMicros);
+
+    // Edges counted in total since setup(), including those not yet
+    // reported
+    uint32_t getTotalCount();
+
+    /*
+     * The frequency of count edges over spanMicros, in thousandths of a
+     * hertz, or 0 if the span is unknown. Takes some time on an 8-bit
+     * MCU, so call it from onCount only when needed.
+     */
+    static uint32_t frequencyMilliHz(uint32_t count, uint32_t spanMicros);
+
+    uint8_t getValue() {
+      return _value;
+    }
+
+    void setup() override;
+    void poll(void* state = nullptr) override;
+    uint16_t idleMs() override;
+
+    // Disable moving and copying
+    PulseCounter(PulseCounter&& other) = delete;
+    PulseCounter& operator=(PulseCounter&& other) = delete;
+    PulseCounter(const PulseCounter&) = delete;
+    PulseCounter& operator=(const PulseCounter&) = delete;
+
+  private:
+    volatile uint32_t _count = 0;     // edges, total
+    volatile uint32_t _lastEdge = 0;  // timestamp of the last edge
+    uint32_t _reportedCount = 0;
+    uint32_t _reportedEdge = 0;
+    uint32_t _reportedMs = 0;  // millis() at the last report
+    uint16_t _reportMs;
+    uint16_t _nextReport = 0;
+    uint8_t _value;
+    bool _hasReportedEdge = false;
+
+};
+
+#endif
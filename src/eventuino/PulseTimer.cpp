@@ -0,0 +1,73 @@
+#include "PulseTimer.h"
+#include "../hal/EventuinoHal.h"
+
+PulseTimer::PulseTimer(uint16_t reportMs, uint8_t value, bool activeHigh):
+    EventSource(), _flags(activeHigh ? PT_ACTIVE_HIGH : 0), _reportMs(reportMs),
+    _value(value) {};
+
+void PulseTimer::edgeFromIsr(uint8_t level) {
+  edgeFromIsr(level, EventuinoHal::micros());
+}
+
+void PulseTimer::edgeFromIsr(uint8_t level, uint32_t timestampMicros) {
+  // Already atomic inside an AVR ISR, but not elsewhere (e.g. a thread)
+  uint8_t saved = EventuinoHal::enterCriticalFromIsr();
+  uint8_t flags = _flags;
+  bool active = (level != EventuinoHal::LOW_STATE) == ((flags & PT_ACTIVE_HIGH) != 0);
+  if (active && !(flags & PT_IN_PULSE)) {
+    _prevStart = _start;
+    _start = timestampMicros;
+    flags |= (flags & PT_HAS_START) ? PT_IN_PULSE | PT_HAS_PREV : PT_IN_PULSE | PT_HAS_START;
+  } else if (!active && (flags & PT_IN_PULSE)) {
+    _width = timestampMicros - _start;
+    _period = (flags & PT_HAS_PREV) ? _start - _prevStart : 0;
+    flags = (flags & ~PT_IN_PULSE) | PT_NEW_PULSE;
+  }
+  _flags = flags | PT_EDGE;
+  EventuinoHal::exitCriticalFromIsr(saved);
+}
+
+void PulseTimer::setup() {
+  _nextReport = (uint16_t)EventuinoHal::millis() + _reportMs;
+}
+
+void PulseTimer::poll(void* state) {
+  uint16_t now = EventuinoHal::millis();
+  if (_reportMs > 0) {
+    if ((int16_t)(now - _nextReport) < 0) return;
+    // On schedule, unless polled more than an interval late
+    _nextReport += _reportMs;
+    if ((int16_t)(now - _nextReport) >= 0) _nextReport = now + _reportMs;
+  }
+
+  uint8_t saved = EventuinoHal::enterCritical();
+  uint8_t flags = _flags;
+  uint32_t width = _width;
+  uint32_t period = _period;
+  bool isNew = flags & PT_NEW_PULSE;
+  // The edges' timestamps needn't share a clock with millis(), so each
+  // one is taken as seen at the report after it. The pulses have stopped
+  // once there have been no edges for longer than their period.
+  if (flags & PT_EDGE) _lastEdgeMs = now;
+  bool stopped = !isNew && _reporting && _reportMs > 0 && !(flags & PT_IN_PULSE)
+      && (flags & PT_HAS_PREV) && (uint32_t)(uint16_t)(now - _lastEdgeMs) * 1000 > period;
+  flags &= ~(PT_NEW_PULSE | PT_EDGE);
+  // The next pulse starts afresh, with no period
+  if (stopped) flags &= ~(PT_HAS_START | PT_HAS_PREV);
+  _flags = flags;
+  EventuinoHal::exitCritical(saved);
+
+  if (!isNew && !stopped) return;
+  _reporting = isNew;
+  if (stopped) {
+    width = 0;
+    period = 0;
+  }
+  if (onPulse != 0) onPulse(_value, width, period, state);
+}
+
+uint16_t PulseTimer::idleMs() {
+  if (_reportMs == 0) return 0;
+  int16_t remaining = (int16_t)(_nextReport - (uint16_t)EventuinoHal::millis());
+  return remaining > 0 ? remaining : 0;
+}
@@ -0,0 +1,115 @@
+/*
+
+  eventuino::PulseTimer.h
+
+  Times the pulses of a signal too fast to poll, such as an RC receiver's
+  PWM output, and reports them at a fixed interval. An interrupt handler
+  calls edgeFromIsr(level) on every edge, which only timestamps it; poll()
+  hands the latest complete pulse's width and period to onPulse, so the
+  per-poll cost is a clock check.
+
+  A pulse is the time the signal spends at the active level, and its
+  period the time from its start to the start of the one before. When the
+  pulses stop (e.g. an RC receiver losing its signal), onPulse is called
+  once more with a width and period of 0, at the first report with no
+  edge for longer than the last period. The edges are only timed to the
+  report that sees them, so that can take up to two report intervals
+  more than the period.
+
+  Invokes callback functions for:
+  - onPulse
+
+  Uses 35 bytes.
+
+  Copyright (c) 2024, Dan Mowehhuk (danmowehhuk@gmail.com)
+  All rights reserved.
+
+*/
+
+#ifndef eventuino_PulseTimer_h
+#define eventuino_PulseTimer_h
+
+#include "../EventSource.h"
+
+using namespace eventuino;
+
+class PulseTimer: public EventSource {
+
+  public:
+    // disable default constructor
+    PulseTimer() = delete;
+
+    /*
+     * reportMs   - Time between reports. 0 reports each new pulse, at
+     *              the next poll(), and never reports the pulses
+     *              stopping.
+     * value      - The value passed to onPulse
+     * activeHigh - Whether pulses are HIGH (default) or LOW
+     */
+    PulseTimer(uint16_t reportMs, uint8_t value, bool activeHigh = true);
+
+    /*
+     * Called each report interval with the latest complete pulse, if
+     * there has been one since the last report.
+     *
+     * widthMicros  - Time at the active level
+     * periodMicros - Time since the start of the pulse before, or 0 if
+     *                it wasn't seen
+     */
+    typedef void (*pulseCallback_t)(uint8_t value, uint32_t widthMicros,
+        uint32_t periodMicros, void* state);
+    pulseCallback_t onPulse = 0;
+
+    /*
+     * Records an edge, from an interrupt handler, timestamped with the
+     * HAL's micros()
+     *
+     * level - The pin's level after the edge
+     */
+    void edgeFromIsr(uint8_t level);
+
+    /*
+     * Records an edge, from an interrupt handler, with a timestamp in
+     * microseconds taken by the hardware, e.g. converted from a timer's
+     * input capture register
+     */
+    void edgeFromIsr(uint8_t level, uint32_t timestampMicros);
+
+    uint8_t getValue() {
+      return _value;
+    }
+
+    void setup() override;
+    void poll(void* state = nullptr) override;
+    uint16_t idleMs() override;
+
+    // Disable moving and copying
+    PulseTimer(PulseTimer&& other) = delete;
+    PulseTimer& operator=(PulseTimer&& other) = delete;
+    PulseTimer(const PulseTimer&) = delete;
+    PulseTimer& operator=(const PulseTimer&) = delete;
+
+  private:
+    enum : uint8_t {
+      PT_ACTIVE_HIGH = 0b0001,  // pulses are HIGH
+      PT_IN_PULSE    = 0b0010,  // at the active level, since _start
+      PT_HAS_START   = 0b0100,  // _start is a pulse start
+      PT_HAS_PREV    = 0b1000,  // _prevStart is too
+      PT_NEW_PULSE   = 0b10000, // _width and _period not yet reported
+      PT_EDGE        = 0b100000 // an edge since the last report
+    };
+
+    volatile uint32_t _start = 0;      // start of the latest pulse
+    volatile uint32_t _prevStart = 0;  // and of the one before
+    volatile uint32_t _width = 0;      // latest complete pulse
+    volatile uint32_t _period = 0;
+    volatile uint8_t _flags;
+    uint16_t _reportMs;
+    uint16_t _nextReport = 0;
+    uint16_t _lastEdgeMs = 0;  // the report that last saw an edge
+    uint8_t _value;
+    bool _reporting = false;  // pulses reported, and not yet stopped
+
+};
+
+#endif
@@ -0,0 +1,93 @@
+#include "SerialLineSource.h"
+#include "../hal/EventuinoHal.h"
+
+static int16_t _eventuinoSerialReadDefault() {
+  return EventuinoHal::serialReadByte();
+}
+
+SerialLineSource::SerialLineSource(uint8_t capacity, uint8_t value, framing_t framing):
+    SerialLineSource(capacity, value, framing, _eventuinoSerialReadDefault) {};
+
+SerialLineSource::SerialLineSource(uint8_t capacity, uint8_t value, framing_t framing,
+      readByteCallback_t readCallback):
+    EventSource(), _doReadByte(readCallback), _capacity(capacity), _value(value),
+    _framing(framing) {
+  _buffer = new uint8_t[capacity > 0 ? capacity : 1];
+};
+
+SerialLineSource::~SerialLineSource() {
+  delete[] _buffer;
+  _buffer = nullptr;
+}
+
+void SerialLineSource::poll(void* state) {
+  uint16_t now = EventuinoHal::millis();
+  if (_frameTimeoutMs > 0 && (_length > 0 || _expected > 0 || _discarding) &&
+      (uint16_t)(now - _lastByteTime) > _frameTimeoutMs) {
+    // The sender stopped mid-frame
+    _length = 0;
+    _expected = 0;
+    _discarding = false;
+  }
+
+  for (uint8_t n = 0; n < _maxBytesPerPoll; n++) {
+    int16_t c = _doReadByte();
+    if (c < 0) break;
+    _lastByteTime = now;
+    receive((uint8_t)c, state);
+  }
+}
+
+void SerialLineSource::receive(uint8_t c, void* state) {
+  if (_framing == FRAMING_LENGTH_PREFIXED) {
+    receiveFramed(c, state);
+  } else {
+    receiveLine(c, state);
+  }
+}
+
+void SerialLineSource::receiveLine(uint8_t c, void* state) {
+  if (c == '\n') {
+    if (!_discarding && _length > 0) dispatch(state);
+    _length = 0;
+    _discarding = false;
+    return;
+  }
+  if (_discarding || c == '\r') return;
+  if (_length + 1 >= _capacity) {
+    // No room for c and the NUL; skip to the next line
+    drop();
+    return;
+  }
+  _buffer[_length++] = c;
+}
+
+void SerialLineSource::receiveFramed(uint8_t c, void* state) {
+  if (_expected == 0) {
+    // A length byte
+    if (c == 0) return;
+    _expected = c;
+    _length = 0;
+    _discarding = false;
+    if (c > _capacity) drop();
+    return;
+  }
+  _expected--;
+  if (!_discarding) _buffer[_length++] = c;
+  if (_expected == 0) {
+    if (!_discarding) dispatch(state);
+    _length = 0;
+    _discarding = false;
+  }
+}
+
+void SerialLineSource::dispatch(void* state) {
+  if (_framing == FRAMING_LINE) _buffer[_length] = '\0';
+  if (onFrame != 0) onFrame(_value, _buffer, _length, state);
+}
+
+void SerialLineSource::drop() {
+  _length = 0;
+  _discarding = true;
+  if (_overflowCount < 0xFF) _overflowCount++;
+}
@@ -0,0 +1,131 @@
+/*
+
+  eventuino::SerialLineSource.h
+
+  Receives commands over a serial port without blocking the loop. Each
+  poll() drains the bytes already received into a fixed buffer, and
+  onFrame is invoked once per complete frame, so command input is
+  handled alongside buttons and timers rather than with a blocking
+  Serial.readStringUntil(...) and its String allocations.
+
+  Frames are either:
+  - FRAMING_LINE: text terminated by '\n'. A '\r' is dropped, so CRLF
+    line endings work too, and empty lines are skipped. The frame passed
+    to onFrame is also NUL-terminated.
+  - FRAMING_LENGTH_PREFIXED: binary frames of a length byte (1-255) and
+    that many bytes. A 0 length byte is skipped.
+
+  A frame longer than the buffer is dropped and counted, and reception
+  picks up again with the next frame.
+
+  Invokes callback functions for:
+  - onFrame
+
+  Uses the buffer capacity, plus 22 bytes.
+
+  Copyright (c) 2024, Dan Mowehhuk (danmowehhuk@gmail.com)
+  All rights reserved.
+
+*/
+
+#ifndef eventuino_SerialLineSource_h
+#define eventuino_SerialLineSource_h
+
+#include "../EventSource.h"
+
+using namespace eventuino;
+
+class SerialLineSource: public EventSource {
+
+  public:
+    enum framing_t : uint8_t {
+      FRAMING_LINE = 0,
+      FRAMING_LENGTH_PREFIXED
+    };
+
+    // disable default constructor
+    SerialLineSource() = delete;
+
+    /*
+     * Constructor reading the HAL's serial port (Serial on Arduino,
+     * USART0 bare metal, or the fd given to attachSerialSource on Linux)
+     *
+     * capacity - Buffer size; the longest frame accepted (one less for
+     *            FRAMING_LINE, leaving room for the NUL)
+     * value    - The value passed to onFrame
+     * framing  - How frames are delimited
+     */
+    SerialLineSource(uint8_t capacity, uint8_t value, framing_t framing = FRAMING_LINE);
+
+    /*
+     * Constructor using a custom callback to read the next byte received,
+     * or -1 if there is none (e.g. for a SoftwareSerial or a second UART)
+     */
+    typedef int16_t (*readByteCallback_t)();
+    SerialLineSource(uint8_t capacity, uint8_t value, framing_t framing,
+        readByteCallback_t readCallback);
+
+    ~SerialLineSource();
+
+    /*
+     * Called with each complete frame. The frame is only valid until the
+     * callback returns.
+     */
+    typedef void (*frameCallback_t)(uint8_t value, const uint8_t* frame,
+        uint8_t length, void* state);
+    frameCallback_t onFrame = 0;
+
+    // Most bytes taken per poll(), bounding the time spent in it
+    // (default 64)
+    void setMaxBytesPerPoll(uint8_t maxBytes) {
+      _maxBytesPerPoll = maxBytes > 0 ? maxBytes : 1;
+    }
+
+    // Drops a partly received frame once no byte has arrived for this
+    // long, so a sender that stopped mid-frame doesn't garble the next
+    // one (default 0: never)
+    void setFrameTimeoutMs(uint16_t timeoutMs) {
+      _frameTimeoutMs = timeoutMs;
+    }
+
+    // Frames dropped for being longer than the buffer
+    uint8_t getOverflowCount() {
+      return _overflowCount;
+    }
+
+    uint8_t getValue() {
+      return _value;
+    }
+
+    void setup() override {};
+    void poll(void* state = nullptr) override;
+
+    // Disable moving and copying
+    SerialLineSource(SerialLineSource&& other) = delete;
+    SerialLineSource& operator=(SerialLineSource&& other) = delete;
+    SerialLineSource(const SerialLineSource&) = delete;
+    SerialLineSource& operator=(const SerialLineSource&) = delete;
+
+  private:
+    void receive(uint8_t c, void* state);
+    void receiveLine(uint8_t c, void* state);
+    void receiveFramed(uint8_t c, void* state);
+    void dispatch(void* state);
+    void drop();
+
+    uint8_t* _buffer;
+    readByteCallback_t _doReadByte;
+    uint16_t _frameTimeoutMs = 0;
+    uint16_t _lastByteTime = 0;
+    uint8_t _capacity;
+    uint8_t _value;
+    framing_t _framing;
+    uint8_t _length = 0;
+    uint8_t _expected = 0;  // FRAMING_LENGTH_PREFIXED: bytes still to come
+    uint8_t _maxBytesPerPoll = 64;
+    uint8_t _overflowCount = 0;
+    bool _discarding = false;
+
+};
+
+#endif
@@ -0,0 +1,73 @@
+#include "Task.h"
+#include "../hal/EventuinoHal.h"
+
+void Task::poll(void* state) {
+  if (!isReady()) return;
+  _wait = WAIT_NONE;
+  _function(this, state);
+}
+
+bool Task::isReady() {
+  switch (_wait & ~WAIT_ARMED) {
+    case WAIT_NONE:
+    case WAIT_CONDITION:
+      return true;
+    case WAIT_MS:
+      return (uint16_t)((uint16_t)EventuinoHal::millis() - _since) >= _awaited.ms;
+    case WAIT_ACTIVE:
+      return _awaited.source->isActive();
+    case WAIT_INACTIVE:
+      return !_awaited.source->isActive();
+    case WAIT_PRESS:
+    case WAIT_RELEASE: {
+      bool target = (_wait & ~WAIT_ARMED) == WAIT_PRESS;
+      if (_awaited.source->isActive() != target) {
+        _wait |= WAIT_ARMED;
+        return false;
+      }
+      return _wait & WAIT_ARMED;
+    }
+    default:
+      return false;
+  }
+}
+
+uint16_t Task::idleMs() {
+  switch (_wait & ~WAIT_ARMED) {
+    case WAIT_NONE:
+    case WAIT_CONDITION:
+      return 0;
+    case WAIT_MS: {
+      uint16_t elapsed = (uint16_t)EventuinoHal::millis() - _since;
+      return elapsed >= _awaited.ms ? 0 : _awaited.ms - elapsed;
+    }
+    default:
+      // Pin waits are woken by their sources' own edges and deadlines
+      return 0xFFFF;
+  }
+}
+
+void Task::awaitMs(uint16_t line, uint16_t ms) {
+  _line = line;
+  _wait = WAIT_MS;
+  _since = EventuinoHal::millis();
+  _awaited.ms = ms;
+}
+
+void Task::awaitState(uint16_t line, DigitalPinSource* source, bool active) {
+  _line = line;
+  _wait = active ? WAIT_ACTIVE : WAIT_INACTIVE;
+  _awaited.source = source;
+}
+
+void Task::awaitEdge(uint16_t line, DigitalPinSource* source, bool active) {
+  _line = line;
+  _wait = active ? WAIT_PRESS : WAIT_RELEASE;
+  if (source->isActive() != active) _wait |= WAIT_ARMED;
+  _awaited.source = source;
+}
+
+void Task::awaitCondition(uint16_t line) {
+  _line = line;
+  _wait = WAIT_CONDITION;
+}
@@ -0,0 +1,154 @@
+/*
+
+  eventuino::Task.h
+
+  A cooperative, stackless task: one function that runs a multi-step
+  sequence (press -> wait 200ms -> check a toggle -> ...) and suspends
+  itself at each await, instead of a tangle of Timers and callbacks.
+  Eventuino only resumes the function once the awaited condition holds;
+  until then, polling the Task is a cheap check.
+
+  The function is written with the TASK_ macros below (protothread
+  style). Because it is resumed by jumping back to the last await, local
+  variables do NOT survive an await; keep anything needed across awaits
+  in the state object. Each await must be on its own line, and awaits
+  can't be used inside a switch statement.
+
+    void blink(Task* task, void* state) {
+      TASK_BEGIN(task);
+      TASK_AWAIT_PRESS(task, &button);
+      TASK_AWAIT_MS(task, 200);
+      if (toggle.isActivated()) ...
+      TASK_END(task);
+    }
+    Task blinker(blink);
+
+  Uses 11 bytes of global variable space.
+
+  NOTE: The awaited DigitalPinSources must still be added to Eventuino,
+  before the Task, so they are polled first in each cycle.
+
+  Copyright (c) 2024, Dan Mowehhuk (danmowehhuk@gmail.com)
+  All rights reserved.
+
+*/
+
+#ifndef eventuino_Task_h
+#define eventuino_Task_h
+
+#include "../EventSource.h"
+#include "DigitalPinSource.h"
+
+using namespace eventuino;
+
+class Task: public EventSource {
+
+  public:
+    typedef void (*taskFunction_t)(Task* task, void* state);
+
+    // disable default constructor
+    Task() = delete;
+
+    // The function is first run on the next poll()
+    Task(taskFunction_t function): EventSource(), _function(function) {};
+
+    void setup() override {};
+    void poll(void* state = nullptr) override;
+    uint16_t idleMs() override;
+
+    // Returns true once the function has reached TASK_END
+    bool isFinished() {
+      return _wait == WAIT_DONE;
+    }
+
+    // Runs the function again from TASK_BEGIN on the next poll()
+    void restart() {
+      _line = 0;
+      _wait = WAIT_NONE;
+    }
+
+    /*
+     * Used by the TASK_ macros - not called directly
+     */
+    uint16_t resumeLine() { return _line; }
+    void awaitMs(uint16_t line, uint16_t ms);
+    void awaitState(uint16_t line, DigitalPinSource* source, bool active);
+    void awaitEdge(uint16_t line, DigitalPinSource* source, bool active);
+    void awaitCondition(uint16_t line);
+    void finish() { _wait = WAIT_DONE; }
+
+  private:
+    enum wait_t : uint8_t {
+      WAIT_NONE = 0,
+      WAIT_MS,
+      WAIT_ACTIVE,
+      WAIT_INACTIVE,
+      WAIT_PRESS,
+      WAIT_RELEASE,
+      WAIT_CONDITION,
+      WAIT_DONE
+    };
+
+    // Edge waits: set once the source has been seen in the opposite state
+    static const uint8_t WAIT_ARMED = 0x80;
+
+    bool isReady();
+
+    taskFunction_t _function;
+    uint16_t _line = 0;
+    uint16_t _since = 0;
+    union {
+      uint16_t ms;
+      DigitalPinSource* source;
+    } _awaited;
+    uint8_t _wait = WAIT_NONE;
+
+};
+
+/*
+ * Starts and ends the task function body
+ */
+#define TASK_BEGIN(task) switch ((task)->resumeLine()) { case 0:
+#define TASK_END(task) } (task)->finish()
+
+/*
+ * Suspends until the next poll()
+ */
+#define TASK_YIELD(task) \
+  do { (task)->awaitMs(__LINE__, 0); return; case __LINE__:; } while (0)
+
+/*
+ * Suspends for at least ms milliseconds (up to 65535)
+ */
+#define TASK_AWAIT_MS(task, ms) \
+  do { (task)->awaitMs(__LINE__, ms); return; case __LINE__:; } while (0)
+
+/*
+ * Suspends until a DigitalPinSource is (or already is) active or inactive
+ */
+#define TASK_AWAIT_ACTIVE(task, source) \
+  do { (task)->awaitState(__LINE__, source, true); return; case __LINE__:; } while (0)
+#define TASK_AWAIT_INACTIVE(task, source) \
+  do { (task)->awaitState(__LINE__, source, false); return; case __LINE__:; } while (0)
+
+/*
+ * Suspends until a DigitalPinSource next becomes active (pressed) or
+ * inactive (released), even if it already is
+ */
+#define TASK_AWAIT_PRESS(task, source) \
+  do { (task)->awaitEdge(__LINE__, source, true); return; case __LINE__:; } while (0)
+#define TASK_AWAIT_RELEASE(task, source) \
+  do { (task)->awaitEdge(__LINE__, source, false); return; case __LINE__:; } while (0)
+
+/*
+ * Suspends until an arbitrary condition is true. The function is resumed
+ * on every poll() to check it, so prefer the waits above where possible.
+ */
+#define TASK_AWAIT_UNTIL(task, condition) \
+  do { \
+    (task)->awaitCondition(__LINE__); \
+    if (0) { case __LINE__:; } \
+    if (!(condition)) return; \
+  } while (0)
+
+#endif
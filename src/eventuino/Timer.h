@@ -12,10 +12,10 @@
   - onExpire
 
   Use one of the following timer classes:
-  - Timer14Bit: 9 bytes, 16s max duration
-  - Timer30Bit: 11 bytes, 1 million seconds max duration (12 days)
-  - IntervalTimer14Bit: 15 bytes, 16s max duration
-  - IntervalTimer30Bit: 19 bytes, 1 million seconds max duration (12 days)
+  - Timer14Bit: 11 bytes, 16s max duration
+  - Timer30Bit: 13 bytes, 1 million seconds max duration (12 days)
+  - IntervalTimer14Bit: 17 bytes, 16s max duration
+  - IntervalTimer30Bit: 21 bytes, 1 million seconds max duration (12 days)
 
   Timers are robust to Arduino's millis() rolling over to 0 after 50 days.
 
@@ -60,29 +60,69 @@ template<class U, class T, uint8_t S> class Timer: public EventSource {
     // required by EventSource
     void poll(void* state = nullptr) override {
       if (!isActive()) return;
-      if (onExpire == 0) {
+      if (!hasHandler()) {
         cancel();
         return;
       }
       if (isExpired()) {
         reset();
-        onExpire(_value, state);
+        emit(onExpire, _value, KIND_EXPIRE, state);
       }
     };
 
+    uint16_t idleMs() override {
+      if (!isActive()) return 0xFFFF;
+      if (isExpired()) return 0;
+      uint32_t remaining = (U)(_state - (U)EventuinoHal::millis()) & TIME_MASK;
+      return remaining > 0xFFFF ? 0xFFFF : remaining;
+    };
+
     /*
      * Start the timer. Calling this again will restart the timer.
      *
      * duration  - The minimum number of milliseconds before onExpire is called
      */
     void start(U duration) {
-      if (onExpire == 0) return;
+      if (!hasHandler()) return;
       uint32_t startTime = EventuinoHal::millis();
       setInterval(startTime, duration);
       updateExpiration(startTime, duration);
       setActive(true);
     };
 
+    /*
+     * Saves the time remaining (and the interval of an IntervalTimer),
+     * or nothing if inactive. Restoring resumes the countdown from the
+     * saved remaining time, not counting the time spent in the reset.
+     */
+    uint8_t snapshotLayout() override {
+      return sizeof(U) == 2 ? SNAPSHOT_TIMER_14BIT : SNAPSHOT_TIMER_30BIT;
+    };
+    uint8_t saveState(uint8_t* buffer) override {
+      if (!isActive()) return 0;
+      U remaining = isExpired() ? 0 : (U)(_state - (U)EventuinoHal::millis()) & TIME_MASK;
+      U interval = getInterval();
+      for (uint8_t i = 0; i < sizeof(U); i++) {
+        buffer[i] = remaining >> (8 * i);
+        buffer[sizeof(U) + i] = interval >> (8 * i);
+      }
+      return 2 * sizeof(U);
+    };
+    void restoreState(const uint8_t* buffer, uint8_t length) override {
+      if (length == 0) cancel();
+      if (length != 2 * sizeof(U)) return;
+      U remaining = 0;
+      U interval = 0;
+      for (uint8_t i = 0; i < sizeof(U); i++) {
+        remaining |= (U)buffer[i] << (8 * i);
+        interval |= (U)buffer[sizeof(U) + i] << (8 * i);
+      }
+      uint32_t now = EventuinoHal::millis();
+      setInterval(now + remaining - interval, interval);
+      updateExpiration(now, remaining);
+      setActive(true);
+    };
+
     /*
      * Cancel the timer
      */
@@ -91,7 +131,7 @@ template<class U, class T, uint8_t S> class Timer: public EventSource {
       setInterval(0, 0);
     };
 
-    eventuinoCallback_t onExpire = 0;
+    EventDelegate onExpire;
 
     // Disable copying
     Timer(const Timer&) = delete;
@@ -124,13 +164,21 @@ template<class U, class T, uint8_t S> class Timer: public EventSource {
     // bits: isActive | isOverflow | expirationTime (all remaining bits)
     U _state = 0;
 
+    // The expirationTime bits of _state: 0b00111111...
+    static const U TIME_MASK = (U)~((U)3 << (S - 2));
+
+    // Either onExpire is set or the routing table handles expiry
+    bool hasHandler() {
+      return (bool)onExpire || isRouted(_value, KIND_EXPIRE);
+    };
+
     virtual void setInterval(uint32_t startTime, U duration) {};
+    virtual U getInterval() { return 0; };
     virtual void reset() { cancel(); };
 
     void updateExpiration(uint32_t startTime, U duration) {
       U expires = startTime + duration;
-      U mask = ~((U)3 << (S - 2)); // 0b00111111...(remaining bits)
-      _state = expires & mask;
+      _state = expires & TIME_MASK;
       if ((1 & bitRead(startTime, S - 3)) & !bitRead(expires, S - 3)) {
         setOverflow(true);
       }
@@ -138,10 +186,9 @@ template<class U, class T, uint8_t S> class Timer: public EventSource {
 
     bool isExpired() {
       bool expired = false;
-      U mask = ~((U)3 << (S - 2));
       uint32_t now = EventuinoHal::millis();
-      U t = now & mask;
-      U expires = _state & mask;
+      U t = now & TIME_MASK;
+      U expires = _state & TIME_MASK;
 
       if (isOverflow() && !bitRead(now, S - 3)) {
         // "now" is in the lower half of U's range
@@ -201,6 +248,11 @@ template<class U, class T, uint8_t S> class IntervalTimer: public Timer<U, T, S>
      */
     IntervalTimer(uint8_t value): Timer<U, T, S>(value) {};
 
+    uint8_t snapshotLayout() override {
+      return sizeof(U) == 2 ? EventSource::SNAPSHOT_INTERVAL_TIMER_14BIT
+          : EventSource::SNAPSHOT_INTERVAL_TIMER_30BIT;
+    };
+
     // Disable copying
     IntervalTimer(const IntervalTimer&) = delete;
     IntervalTimer& operator=(const IntervalTimer&) = delete;
@@ -232,6 +284,10 @@ template<class U, class T, uint8_t S> class IntervalTimer: public Timer<U, T, S>
       _interval = duration;
     };
 
+    U getInterval() {
+      return _interval;
+    };
+
     void reset() {
       this->updateExpiration(_prev, _interval);
       _prev += _interval;
@@ -3,14 +3,12 @@
 using namespace eventuino;
 
 void Toggle::onChange(uint8_t value, void* state) {
-  if (isActive() && onActivate != 0) {
-    onActivate(value, state);
-  } else if (!isActive() && onDeactivate != 0) {
-    onDeactivate(value, state);
-  }
-  if (onFlip != 0) {
-    onFlip(value, state);
+  if (isActive()) {
+    emit(onActivate, value, KIND_ACTIVATE, state);
+  } else {
+    emit(onDeactivate, value, KIND_DEACTIVATE, state);
   }
+  emit(onFlip, value, KIND_CHANGE, state);
 }
 
 bool Toggle::isActivated() {
@@ -48,9 +48,9 @@ class Toggle: public DigitalPinSource {
         pinSetupCallback_t setupCallback, digitalReadCallback_t readCallback):
         DigitalPinSource(pinNumber, value, setupCallback, readCallback) {};
 
-    eventuinoCallback_t onFlip = 0;
-    eventuinoCallback_t onActivate = 0;
-    eventuinoCallback_t onDeactivate = 0;
+    EventDelegate onFlip;
+    EventDelegate onActivate;
+    EventDelegate onDeactivate;
     void clearCallbacks();
 
     bool isActivated();
@@ -73,4 +73,45 @@ class Toggle: public DigitalPinSource {
 
 };
 
+/*
+ * A Toggle whose debounce delay is a compile-time constant rather than
+ * the static delay shared by every DigitalPinSource. The 
+ * setDebounceDelayMs setter has no effect on a BasicToggle.
+ *
+ * Template params:
+ *   DebounceMs - debounce delay (default 75ms)
+ */
+template<uint8_t DebounceMs = 75>
+class BasicToggle: public Toggle {
+
+  public:
+    BasicToggle() = delete;
+
+    BasicToggle(uint8_t pinNumber, uint8_t value): Toggle(pinNumber, value) {};
+
+    BasicToggle(uint8_t pinNumber, uint8_t value, 
+        pinSetupCallback_t setupCallback, digitalReadCallback_t readCallback):
+        Toggle(pinNumber, value, setupCallback, readCallback) {};
+
+    // Toggles have no long hold, so it can never be reached
+    void poll(void* state = nullptr) override {
+      pollTimed(DebounceMs, 0xFFFF, 0xFF, state);
+    };
+
+    uint16_t idleMs() override {
+      return idleTimed(DebounceMs, 0xFFFF, 0xFF);
+    };
+
+    // Allow moving
+    BasicToggle(BasicToggle&& other) noexcept: Toggle(this->move(other)) {};
+    BasicToggle& operator=(BasicToggle&& other) noexcept {
+      Toggle::operator=(this->move(other));
+      return *this;
+    };
+    // Disable copying
+    BasicToggle(const BasicToggle&) = delete;
+    BasicToggle& operator=(const BasicToggle&) = delete;
+
+};
+
 #endif
@@ -1,7 +1,11 @@
 #include "EventuinoHal.h"
 
-#ifdef NO_ARDUINO
+#if defined(NO_ARDUINO) && !defined(HAL_LINUX)
 #include <BareMetalHAL.h>
+#include <avr/interrupt.h>
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+#include <util/delay.h>
 
 namespace EventuinoHal {
 
@@ -16,14 +20,114 @@ uint8_t digitalReadPin(uint8_t pin) {
   return BareMetalHAL::digitalRead(pin);
 }
 
+// BareMetalHAL owns the mapping from its pin numbers to ports, so reads
+// go through BareMetalHAL::digitalRead(...)
+volatile uint8_t* inputRegister(uint8_t, uint8_t&) {
+  return nullptr;
+}
+
 unsigned long millis() {
   return BareMetalHAL::millis();
 }
 
+unsigned long micros() {
+  return BareMetalHAL::micros();
+}
+
 void println(const char* message) {
   BareMetalHAL::Uart0::println(message);
 }
 
+// Polls USART0's receive flag. Don't combine with a receive interrupt,
+// which would take the bytes first.
+int16_t serialReadByte() {
+#ifdef UDR0
+  if (UCSR0A & (1 << RXC0)) return UDR0;
+#endif
+  return -1;
+}
+
+uint8_t waitForEdge(uint32_t) {
+  return 0;
+}
+
+uint8_t enterCritical() {
+  uint8_t sreg = SREG;
+  cli();
+  return sreg;
+}
+
+void exitCritical(uint8_t saved) {
+  SREG = saved;
+}
+
+void pinModeInputPullups(const uint8_t* pins, uint8_t count) {
+  for (uint8_t i = 0; i < count; i++) {
+    BareMetalHAL::pinMode(pins[i], BareMetalHAL::INPUT_PULLUP);
+  }
+}
+
+void delayMicros(uint16_t micros) {
+  while (micros-- > 0) _delay_us(1);
+}
+
+void pinModeOutput(uint8_t pin) {
+  BareMetalHAL::pinMode(pin, BareMetalHAL::OUTPUT);
+}
+
+void digitalWritePin(uint8_t pin, uint8_t level) {
+  BareMetalHAL::digitalWrite(pin, level);
+}
+
+void digitalWritePins(const uint8_t* pins, uint8_t count, uint8_t levels,
+    uint8_t mask) {
+  uint8_t saved = enterCritical();
+  for (uint8_t i = 0; i < count; i++) {
+    if (mask & (1 << i)) {
+      BareMetalHAL::digitalWrite(pins[i], (levels & (1 << i))
+          ? BareMetalHAL::HIGH : BareMetalHAL::LOW);
+    }
+  }
+  exitCritical(saved);
+}
+
+uint8_t readFlashByte(const uint8_t* address) {
+  return pgm_read_byte(address);
+}
+
+const uint8_t ANALOG_REF_EXTERNAL = 0;
+const uint8_t ANALOG_REF_AVCC = 1;
+const uint8_t ANALOG_REF_INTERNAL = 3;
+
+namespace {
+uint8_t analogReferenceMode = ANALOG_REF_AVCC;
+}  // namespace
+
+void setAnalogReference(uint8_t mode) {
+  analogReferenceMode = mode & 0x03;
+}
+
+void analogStart(uint8_t pin) {
+  if ((ADCSRA & (1 << ADEN)) == 0) {
+    // The reference is set with each channel below; prescale the ADC
+    // clock to its 50-200kHz range (F_CPU/128)
+    ADCSRA = (1 << ADEN) | (1 << ADPS2) | (1 << ADPS1) | (1 << ADPS0);
+  }
+#ifdef MUX5
+  ADCSRB = (ADCSRB & ~(1 << MUX5)) | (((pin >> 3) & 0x01) << MUX5);
+#endif
+  ADMUX = (analogReferenceMode << REFS0) | (pin & 0x07);
+  ADCSRA |= (1 << ADSC);
+}
+
+bool analogReady() {
+  return (ADCSRA & (1 << ADSC)) == 0;
+}
+
+uint16_t analogResult() {
+  return ADC;
+}
+
 }  // namespace EventuinoHal
 
-#endif  // NO_ARDUINO
+#endif  // NO_ARDUINO && !HAL_LINUX
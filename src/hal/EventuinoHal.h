@@ -4,7 +4,8 @@
 
   This namespace consolidates the GPIO, Timing, and Serial calls
   Eventuino's core (src/) needs so they can be redirected to
-  BareMetalHAL when building with -DNO_ARDUINO.
+  BareMetalHAL when building with -DNO_ARDUINO, or to Linux's GPIO
+  character devices when building with -DNO_ARDUINO -DHAL_LINUX.
 
   Copyright (c) 2024, Dan Mowehhuk (danmowehhuk@gmail.com)
   All rights reserved.
@@ -34,9 +35,178 @@ const uint8_t LOW_STATE = LOW;
 // directly instead of exposing a generic pinMode()/INPUT_PULLUP pair.
 inline void pinModeInputPullup(uint8_t pin) { pinMode(pin, INPUT_PULLUP); }
 inline uint8_t digitalReadPin(uint8_t pin) { return digitalRead(pin); }
+
+// Resolves the input register and bit mask behind digitalReadPin(pin), so
+// a caller can cache them and read the pin with a single load and mask
+// (see readInputRegister). Returns nullptr, leaving mask unchanged, where
+// the pin isn't read that way; keep using digitalReadPin(pin) then.
+#if defined(__AVR__) && defined(portInputRegister)
+inline volatile uint8_t* inputRegister(uint8_t pin, uint8_t& mask) {
+  uint8_t port = digitalPinToPort(pin);
+  if (port == NOT_A_PIN) return nullptr;
+  mask = digitalPinToBitMask(pin);
+  return portInputRegister(port);
+}
+#else
+inline volatile uint8_t* inputRegister(uint8_t, uint8_t&) { return nullptr; }
+#endif
 inline unsigned long millis() { return ::millis(); }
+inline unsigned long micros() { return ::micros(); }
 inline void println(const char* message) { Serial.println(message); }
 
+// The next byte received on Serial, or -1 if there is none
+inline int16_t serialReadByte() { return Serial.read(); }
+
+// Arduino has no edge events to wait for, so this returns immediately
+// and the caller simply polls again.
+inline uint8_t waitForEdge(uint32_t) { return 0; }
+
+// Guards data shared with interrupt handlers. enterCritical() disables
+// interrupts and returns what exitCritical() needs to restore them. On
+// AVR and Cortex-M that is the interrupt state itself (SREG or PRIMASK),
+// so sections nest and can be used inside an ISR. Other cores only have
+// noInterrupts() and interrupts(), so there sections don't nest, and
+// exitCritical() always enables interrupts, even inside an ISR.
+//
+// The edgeFromIsr(...) entry points use enterCriticalFromIsr() instead,
+// which on those other cores does nothing, since the loop can't run
+// while an ISR does.
+#if defined(__AVR__)
+inline uint8_t enterCritical() { uint8_t sreg = SREG; noInterrupts(); return sreg; }
+inline void exitCritical(uint8_t saved) { SREG = saved; }
+inline uint8_t enterCriticalFromIsr() { return enterCritical(); }
+inline void exitCriticalFromIsr(uint8_t saved) { exitCritical(saved); }
+#elif defined(__arm__) && defined(__ARM_ARCH_PROFILE) && __ARM_ARCH_PROFILE == 'M'
+inline uint8_t enterCritical() {
+  uint32_t primask;
+  __asm__ volatile ("mrs %0, primask" : "=r" (primask) :: "memory");
+  __asm__ volatile ("cpsid i" ::: "memory");
+  return primask & 1;
+}
+inline void exitCritical(uint8_t saved) {
+  if (!saved) __asm__ volatile ("cpsie i" ::: "memory");
+}
+inline uint8_t enterCriticalFromIsr() { return enterCritical(); }
+inline void exitCriticalFromIsr(uint8_t saved) { exitCritical(saved); }
+#else
+inline uint8_t enterCritical() { noInterrupts(); return 0; }
+inline void exitCritical(uint8_t) { interrupts(); }
+inline uint8_t enterCriticalFromIsr() { return 0; }
+inline void exitCriticalFromIsr(uint8_t) {}
+#endif
+
+// Sets each of pins to INPUT_PULLUP. On AVR, runs of pins on the same
+// port are set with a single write to each of its registers.
+#if defined(__AVR__) && defined(portModeRegister)
+inline void pinModeInputPullups(const uint8_t* pins, uint8_t count) {
+  uint8_t saved = enterCritical();
+  for (uint8_t i = 0; i < count;) {
+    uint8_t port = digitalPinToPort(pins[i]);
+    uint8_t bits = 0;
+    for (; i < count && digitalPinToPort(pins[i]) == port; i++) {
+      bits |= digitalPinToBitMask(pins[i]);
+    }
+    if (port == NOT_A_PIN) continue;
+    *portModeRegister(port) &= ~bits;
+    *portOutputRegister(port) |= bits;
+  }
+  exitCritical(saved);
+}
+#else
+inline void pinModeInputPullups(const uint8_t* pins, uint8_t count) {
+  for (uint8_t i = 0; i < count; i++) pinMode(pins[i], INPUT_PULLUP);
+}
+#endif
+
+inline void delayMicros(uint16_t micros) { delayMicroseconds(micros); }
+
+inline void pinModeOutput(uint8_t pin) { pinMode(pin, OUTPUT); }
+inline void digitalWritePin(uint8_t pin, uint8_t level) { digitalWrite(pin, level); }
+
+// Writes pins[i] HIGH or LOW per bit i of levels, for the bits set in
+// mask only. On AVR, runs of pins on the same port are written with a
+// single read-modify-write of the port register.
+#if defined(__AVR__) && defined(portOutputRegister)
+inline void digitalWritePins(const uint8_t* pins, uint8_t count, uint8_t levels,
+    uint8_t mask) {
+  volatile uint8_t* out = 0;
+  uint8_t set = 0;
+  uint8_t clear = 0;
+  uint8_t saved = enterCritical();
+  for (uint8_t i = 0; i < count && mask != 0; i++, levels >>= 1, mask >>= 1) {
+    if ((mask & 0x01) == 0) continue;
+    volatile uint8_t* pinOut = portOutputRegister(digitalPinToPort(pins[i]));
+    if (pinOut != out) {
+      if (out != 0) *out = (*out & ~clear) | set;
+      out = pinOut;
+      set = clear = 0;
+    }
+    if (levels & 0x01) {
+      set |= digitalPinToBitMask(pins[i]);
+    } else {
+      clear |= digitalPinToBitMask(pins[i]);
+    }
+  }
+  if (out != 0) *out = (*out & ~clear) | set;
+  exitCritical(saved);
+}
+#else
+inline void digitalWritePins(const uint8_t* pins, uint8_t count, uint8_t levels,
+    uint8_t mask) {
+  for (uint8_t i = 0; i < count; i++) {
+    if (mask & (1 << i)) digitalWrite(pins[i], (levels & (1 << i)) ? HIGH : LOW);
+  }
+}
+#endif
+
+// Reads a byte of a table that may have been placed in flash (PROGMEM)
+#ifdef pgm_read_byte
+inline uint8_t readFlashByte(const uint8_t* address) { return pgm_read_byte(address); }
+#else
+inline uint8_t readFlashByte(const uint8_t* address) { return *address; }
+#endif
+
+// Split analog conversion: analogStart() begins converting, analogReady()
+// reports when it's done, and analogResult() returns it, so a caller can
+// do other work meanwhile. On AVR this drives the ADC registers directly,
+// with the prescaler the Arduino core set up in init() and the reference
+// given to setAnalogReference(). Elsewhere analogStart() does a blocking
+// analogRead(), using the core's analogReference().
+#if defined(__AVR__) && defined(ADSC)
+inline uint8_t& analogReferenceMode() { static uint8_t mode = DEFAULT; return mode; }
+
+// The ADC reference for analogStart(): DEFAULT (AVcc), EXTERNAL or one of
+// the INTERNAL references, as for analogReference(), which it also calls.
+// It must match the board's AREF wiring: selecting an internal reference
+// or AVcc while a voltage is applied to AREF shorts them together.
+inline void setAnalogReference(uint8_t mode) {
+  analogReferenceMode() = mode;
+  analogReference(mode);
+}
+
+inline void analogStart(uint8_t pin) {
+  // Like analogRead(), accept either a channel or an A0.. pin number
+  uint8_t channel = pin >= A0 ? pin - A0 : pin;
+#ifdef analogPinToChannel
+  channel = analogPinToChannel(channel);
+#endif
+#ifdef MUX5
+  ADCSRB = (ADCSRB & ~(1 << MUX5)) | (((channel >> 3) & 0x01) << MUX5);
+#endif
+  ADMUX = (analogReferenceMode() << 6) | (channel & 0x07);
+  ADCSRA |= (1 << ADSC);
+}
+inline bool analogReady() { return (ADCSRA & (1 << ADSC)) == 0; }
+inline uint16_t analogResult() { return ADC; }
+#else
+inline uint16_t& analogValue() { static uint16_t value = 0; return value; }
+// analogRead() already uses the reference given to analogReference()
+inline void setAnalogReference(uint8_t) {}
+inline void analogStart(uint8_t pin) { analogValue() = analogRead(pin); }
+inline bool analogReady() { return true; }
+inline uint16_t analogResult() { return analogValue(); }
+#endif
+
 #else
 
 extern const uint8_t HIGH_STATE;
@@ -44,11 +214,114 @@ extern const uint8_t LOW_STATE;
 
 void pinModeInputPullup(uint8_t pin);
 uint8_t digitalReadPin(uint8_t pin);
+
+// Resolves the input register and bit mask behind digitalReadPin(pin), so
+// a caller can cache them (see readInputRegister). Returns nullptr where
+// the pin isn't read that way; keep using digitalReadPin(pin) then.
+volatile uint8_t* inputRegister(uint8_t pin, uint8_t& mask);
 unsigned long millis();
+unsigned long micros();
 void println(const char* message);
 
+// The next byte received on the serial port, or -1 if there is none
+int16_t serialReadByte();
+
+// Blocks until a pin edge arrives or timeoutMs passes, returning the
+// number of edges seen. Returns 0 immediately on HALs without edge
+// events.
+uint8_t waitForEdge(uint32_t timeoutMs);
+
+// Guards data shared with interrupt handlers (or, on Linux, other
+// threads). Pass exitCritical() what enterCritical() returned. Sections
+// nest, and can be used inside an ISR.
+uint8_t enterCritical();
+void exitCritical(uint8_t saved);
+inline uint8_t enterCriticalFromIsr() { return enterCritical(); }
+inline void exitCriticalFromIsr(uint8_t saved) { exitCritical(saved); }
+
+// Sets each of pins to INPUT_PULLUP
+void pinModeInputPullups(const uint8_t* pins, uint8_t count);
+
+// Busy-waits for a short time, e.g. while pull-ups charge the inputs
+void delayMicros(uint16_t micros);
+
+void pinModeOutput(uint8_t pin);
+void digitalWritePin(uint8_t pin, uint8_t level);
+
+// Writes pins[i] HIGH or LOW per bit i of levels, for the bits set in
+// mask only
+void digitalWritePins(const uint8_t* pins, uint8_t count, uint8_t levels,
+    uint8_t mask);
+
+// Reads a byte of a table that may have been placed in flash (PROGMEM)
+uint8_t readFlashByte(const uint8_t* address);
+
+// The ADC reference for analogStart(), as the REFS1:REFS0 bits of ADMUX:
+// ANALOG_REF_AVCC (the default), ANALOG_REF_EXTERNAL or
+// ANALOG_REF_INTERNAL. It must match the board's AREF wiring: selecting
+// an internal reference or AVcc while a voltage is applied to AREF
+// shorts them together. Ignored on Linux.
+extern const uint8_t ANALOG_REF_EXTERNAL;
+extern const uint8_t ANALOG_REF_AVCC;
+extern const uint8_t ANALOG_REF_INTERNAL;
+void setAnalogReference(uint8_t mode);
+
+// Split analog conversion: analogStart() begins converting the pin (an
+// ADC channel number), analogReady() reports when it's done, and
+// analogResult() returns it, so a caller can do other work meanwhile
+void analogStart(uint8_t pin);
+bool analogReady();
+uint16_t analogResult();
+
+#ifdef HAL_LINUX
+
+// Opens a GPIO character device (e.g. "/dev/gpiochip0"). Afterwards,
+// pinModeInputPullup(pin) requests line offset "pin" from it with a
+// pull-up bias and kernel edge events on both edges. closeGpioChip()
+// releases every line requested from it, inputs and outputs.
+bool openGpioChip(const char* path);
+void closeGpioChip();
+
+// Uses any pollable fd delivering struct gpio_v2_line_event records as
+// the edge source for a pin, starting at the given level. This is how
+// pinModeInputPullup attaches a line, and lets a pipe or eventfd stand
+// in for real GPIO hardware. detachEdgeSource only closes the fd if
+// pinModeInputPullup requested it; one passed in stays the caller's.
+void attachEdgeSource(uint8_t pin, int fd, uint8_t level);
+void detachEdgeSource(uint8_t pin);
+
+// Kernel timestamp (CLOCK_MONOTONIC ns) of the pin's last edge
+uint64_t lastEdgeNs(uint8_t pin);
+
+// Makes a waitForEdge() in progress on another thread return early
+void interruptWait();
+
+// Replaces millis() on the calling thread with the given clock, or
+// restores CLOCK_MONOTONIC when passed nullptr. Lets simulations and
+// tests run sources on virtual time.
+typedef unsigned long (*clockSource_t)();
+void setClockSource(clockSource_t source);
+
+// Linux has no on-chip ADC; analog conversions call this reader instead,
+// e.g. one backed by an IIO device or, in tests, simulated inputs.
+// Without one, every conversion reads 0.
+typedef uint16_t (*analogReader_t)(uint8_t pin);
+void setAnalogReader(analogReader_t reader);
+
+// Makes serialReadByte() read from fd, without blocking: e.g. a tty the
+// caller opened and set to raw mode, a socket, or in tests a pipe. Pass
+// -1 to detach it.
+void attachSerialSource(int fd);
+
 #endif
 
+#endif
+
+// Reads a pin through the register and mask from inputRegister(...)
+inline uint8_t readInputRegister(volatile uint8_t* reg, uint8_t mask) {
+  return (*reg & mask) ? HIGH_STATE : LOW_STATE;
+}
+
 }  // namespace EventuinoHal
 
 #endif
@@ -0,0 +1,334 @@
+#include "EventuinoHal.h"
+
+#if defined(NO_ARDUINO) && defined(HAL_LINUX)
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/gpio.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <time.h>
+#include <unistd.h>
+#include <atomic>
+
+namespace EventuinoHal {
+
+const uint8_t HIGH_STATE = 1;
+const uint8_t LOW_STATE = 0;
+
+namespace {
+
+struct EdgeSource {
+  int fd = -1;
+  bool owned = false;  // a line requested by the HAL, closed on detach
+  uint8_t level = 1;  // unattached pins read as pulled up
+  uint64_t lastEdgeNs = 0;
+};
+
+EdgeSource edgeSources[256];
+int outputFds[256];
+bool outputFdsReady = false;
+int chipFd = -1;
+int epollFd = -1;
+int wakeFd = -1;
+
+// epoll data for wakeFd, outside the range of pin numbers
+const uint32_t WAKE_TOKEN = 0x100;
+
+void ensureEpoll() {
+  if (epollFd >= 0) return;
+  epollFd = epoll_create1(EPOLL_CLOEXEC);
+  wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  struct epoll_event ev;
+  memset(&ev, 0, sizeof(ev));
+  ev.events = EPOLLIN;
+  ev.data.u32 = WAKE_TOKEN;
+  epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &ev);
+}
+
+uint64_t monotonicNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+// Applies every edge event waiting on the pin's fd, without blocking
+uint8_t drainEdges(uint8_t pin) {
+  EdgeSource& src = edgeSources[pin];
+  struct gpio_v2_line_event events[16];
+  uint8_t count = 0;
+  while (src.fd >= 0) {
+    ssize_t n = read(src.fd, events, sizeof(events));
+    if (n < (ssize_t)sizeof(events[0])) break;
+    for (size_t i = 0; i < n / sizeof(events[0]); i++) {
+      src.level = events[i].id == GPIO_V2_LINE_EVENT_RISING_EDGE ? HIGH_STATE : LOW_STATE;
+      src.lastEdgeNs = events[i].timestamp_ns;
+      if (count < 0xFF) count++;
+    }
+  }
+  return count;
+}
+
+// Per-thread millis() override, see setClockSource()
+thread_local clockSource_t clockSource = nullptr;
+
+// Stands in for an ADC, see setAnalogReader()
+analogReader_t analogReader = nullptr;
+uint16_t analogValue = 0;
+
+// Serial input, see attachSerialSource(), read a buffer at a time
+int serialFd = -1;
+uint8_t serialBuffer[64];
+uint8_t serialHead = 0;
+uint8_t serialCount = 0;
+
+// There are no interrupts to disable, so critical sections take a
+// spinlock instead, held by the outermost section on a thread
+std::atomic_flag criticalLock = ATOMIC_FLAG_INIT;
+thread_local uint8_t criticalDepth = 0;
+
+}  // namespace
+
+void pinModeInputPullup(uint8_t pin) {
+  if (chipFd < 0) return;
+
+  struct gpio_v2_line_request req;
+  memset(&req, 0, sizeof(req));
+  req.offsets[0] = pin;
+  req.num_lines = 1;
+  strncpy(req.consumer, "eventuino", sizeof(req.consumer) - 1);
+  req.config.flags = GPIO_V2_LINE_FLAG_INPUT | GPIO_V2_LINE_FLAG_BIAS_PULL_UP |
+      GPIO_V2_LINE_FLAG_EDGE_RISING | GPIO_V2_LINE_FLAG_EDGE_FALLING;
+  if (ioctl(chipFd, GPIO_V2_GET_LINE_IOCTL, &req) < 0) {
+    perror("eventuino: GPIO_V2_GET_LINE_IOCTL");
+    return;
+  }
+
+  struct gpio_v2_line_values values;
+  memset(&values, 0, sizeof(values));
+  values.mask = 1;
+  uint8_t level = HIGH_STATE;
+  if (ioctl(req.fd, GPIO_V2_LINE_GET_VALUES_IOCTL, &values) == 0) {
+    level = (values.bits & 1) ? HIGH_STATE : LOW_STATE;
+  }
+  attachEdgeSource(pin, req.fd, level);
+  if (edgeSources[pin].fd == req.fd) {
+    edgeSources[pin].owned = true;
+  } else {
+    close(req.fd);
+  }
+}
+
+// Each line is requested separately, with its own fd for edge events
+void pinModeInputPullups(const uint8_t* pins, uint8_t count) {
+  for (uint8_t i = 0; i < count; i++) pinModeInputPullup(pins[i]);
+}
+
+void delayMicros(uint16_t micros) {
+  struct timespec ts = { 0, (long)micros * 1000 };
+  nanosleep(&ts, nullptr);
+}
+
+uint8_t digitalReadPin(uint8_t pin) {
+  drainEdges(pin);
+  return edgeSources[pin].level;
+}
+
+// Lines are read through their edge events, never a register
+volatile uint8_t* inputRegister(uint8_t, uint8_t&) {
+  return nullptr;
+}
+
+void pinModeOutput(uint8_t pin) {
+  if (!outputFdsReady) {
+    for (int i = 0; i < 256; i++) outputFds[i] = -1;
+    outputFdsReady = true;
+  }
+  if (chipFd < 0 || outputFds[pin] >= 0) return;
+
+  struct gpio_v2_line_request req;
+  memset(&req, 0, sizeof(req));
+  req.offsets[0] = pin;
+  req.num_lines = 1;
+  strncpy(req.consumer, "eventuino", sizeof(req.consumer) - 1);
+  req.config.flags = GPIO_V2_LINE_FLAG_OUTPUT;
+  if (ioctl(chipFd, GPIO_V2_GET_LINE_IOCTL, &req) < 0) {
+    perror("eventuino: GPIO_V2_GET_LINE_IOCTL");
+    return;
+  }
+  outputFds[pin] = req.fd;
+}
+
+void digitalWritePin(uint8_t pin, uint8_t level) {
+  if (!outputFdsReady || outputFds[pin] < 0) return;
+  struct gpio_v2_line_values values;
+  memset(&values, 0, sizeof(values));
+  values.mask = 1;
+  values.bits = level == LOW_STATE ? 0 : 1;
+  ioctl(outputFds[pin], GPIO_V2_LINE_SET_VALUES_IOCTL, &values);
+}
+
+void digitalWritePins(const uint8_t* pins, uint8_t count, uint8_t levels,
+    uint8_t mask) {
+  for (uint8_t i = 0; i < count; i++) {
+    if (mask & (1 << i)) digitalWritePin(pins[i], (levels >> i) & 0x01);
+  }
+}
+
+uint8_t readFlashByte(const uint8_t* address) {
+  return *address;
+}
+
+void attachSerialSource(int fd) {
+  if (fd >= 0) fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+  serialFd = fd;
+  serialHead = 0;
+  serialCount = 0;
+}
+
+int16_t serialReadByte() {
+  if (serialHead == serialCount) {
+    if (serialFd < 0) return -1;
+    ssize_t n = read(serialFd, serialBuffer, sizeof(serialBuffer));
+    if (n <= 0) return -1;
+    serialHead = 0;
+    serialCount = n;
+  }
+  return serialBuffer[serialHead++];
+}
+
+const uint8_t ANALOG_REF_EXTERNAL = 0;
+const uint8_t ANALOG_REF_AVCC = 1;
+const uint8_t ANALOG_REF_INTERNAL = 3;
+
+// The analog reader scales its own readings
+void setAnalogReference(uint8_t) {}
+
+void setAnalogReader(analogReader_t reader) {
+  analogReader = reader;
+}
+
+void analogStart(uint8_t pin) {
+  analogValue = analogReader != nullptr ? analogReader(pin) : 0;
+}
+
+bool analogReady() {
+  return true;
+}
+
+uint16_t analogResult() {
+  return analogValue;
+}
+
+void setClockSource(clockSource_t source) {
+  clockSource = source;
+}
+
+unsigned long millis() {
+  if (clockSource != nullptr) return clockSource();
+  return monotonicNs() / 1000000ull;
+}
+
+unsigned long micros() {
+  if (clockSource != nullptr) return clockSource() * 1000ul;
+  return monotonicNs() / 1000ull;
+}
+
+void println(const char* message) {
+  puts(message);
+  fflush(stdout);
+}
+
+uint8_t waitForEdge(uint32_t timeoutMs) {
+  ensureEpoll();
+  struct epoll_event ready[16];
+  int n = epoll_wait(epollFd, ready, 16, timeoutMs > 0x7FFFFFFF ? -1 : (int)timeoutMs);
+  uint8_t count = 0;
+  for (int i = 0; i < n; i++) {
+    if (ready[i].data.u32 == WAKE_TOKEN) {
+      uint64_t wakes;
+      if (read(wakeFd, &wakes, sizeof(wakes)) < 0) {}
+      continue;
+    }
+    uint8_t edges = drainEdges((uint8_t)ready[i].data.u32);
+    count = (count + edges < 0xFF) ? count + edges : 0xFF;
+  }
+  return count;
+}
+
+uint8_t enterCritical() {
+  if (criticalDepth++ == 0) {
+    while (criticalLock.test_and_set(std::memory_order_acquire)) {}
+  }
+  return 0;
+}
+
+void exitCritical(uint8_t) {
+  if (--criticalDepth == 0) criticalLock.clear(std::memory_order_release);
+}
+
+void interruptWait() {
+  ensureEpoll();
+  uint64_t one = 1;
+  if (write(wakeFd, &one, sizeof(one)) < 0) {}
+}
+
+bool openGpioChip(const char* path) {
+  closeGpioChip();
+  chipFd = open(path, O_RDWR | O_CLOEXEC);
+  if (chipFd < 0) perror("eventuino: open gpiochip");
+  return chipFd >= 0;
+}
+
+// Releases the lines requested from the chip too, so it can be reopened
+void closeGpioChip() {
+  for (int pin = 0; pin < 256; pin++) {
+    if (edgeSources[pin].owned) detachEdgeSource(pin);
+  }
+  if (outputFdsReady) {
+    for (int pin = 0; pin < 256; pin++) {
+      if (outputFds[pin] >= 0) close(outputFds[pin]);
+      outputFds[pin] = -1;
+    }
+  }
+  if (chipFd >= 0) close(chipFd);
+  chipFd = -1;
+}
+
+void attachEdgeSource(uint8_t pin, int fd, uint8_t level) {
+  detachEdgeSource(pin);
+  ensureEpoll();
+
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+  struct epoll_event ev;
+  memset(&ev, 0, sizeof(ev));
+  ev.events = EPOLLIN;
+  ev.data.u32 = pin;
+  if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+    perror("eventuino: epoll_ctl");
+    return;
+  }
+  edgeSources[pin].fd = fd;
+  edgeSources[pin].level = level;
+  edgeSources[pin].lastEdgeNs = 0;
+}
+
+void detachEdgeSource(uint8_t pin) {
+  EdgeSource& src = edgeSources[pin];
+  if (src.fd < 0) return;
+  epoll_ctl(epollFd, EPOLL_CTL_DEL, src.fd, nullptr);
+  if (src.owned) close(src.fd);
+  src.fd = -1;
+  src.owned = false;
+  src.level = HIGH_STATE;
+}
+
+uint64_t lastEdgeNs(uint8_t pin) {
+  return edgeSources[pin].lastEdgeNs;
+}
+
+}  // namespace EventuinoHal
+
+#endif  // NO_ARDUINO && HAL_LINUX
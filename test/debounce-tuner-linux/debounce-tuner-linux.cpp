@@ -0,0 +1,375 @@
+// Host-native Monte-Carlo debounce tuner for the -DHAL_LINUX build. Runs
+// the real DigitalPinSource debounce logic, on virtual time, against
+// simulated presses with contact bounce and EMI glitches, for every
+// candidate debounce delay and mode, in parallel on all cores. For each
+// it reports the error rate (extra or missed presses) and the latency
+// the debounce adds, then recommends the fastest setting within the
+// acceptable error rate.
+//
+// Build and run with ./build.sh -r -- [options]
+//
+//   -n COUNT    Presses simulated per candidate (2000)
+//   -d LIST     Debounce delays to try, in ms (1,2,3,5,8,10,15,20,30,50,75).
+//               DEBOUNCE_INTEGRATOR rounds them down to multiples of 8ms
+//               (at least 8), and each distinct one is tried once.
+//   -m MODE     stable, eager, integrator or all (all)
+//   -b MIN-MAX  Bounces per press or release (2-8)
+//   -u MICROS   Mean length of each bounce, exponentially distributed (300)
+//   -w MS       Longest a press or release keeps bouncing (5)
+//   -e RATE     EMI glitches per second, at random times (0)
+//   -g MICROS   Length of each glitch (50)
+//   -t MIN-MAX  Time each press is held, and released after it, in ms
+//               (40-400)
+//   -p MICROS   Time between polls (250)
+//   -r PERCENT  Acceptable error rate for the recommendation (0)
+//   -j THREADS  Worker threads (one per core)
+//   -s SEED     Random seed (1)
+//
+// A press's latency is timed from its first contact to onPressed, and
+// a release's from its first break to the release callback. The virtual
+// clock advances by -p between polls, so the latencies include up to one
+// poll interval of sampling delay. Exits with status 1 if no candidate is
+// within the acceptable error rate.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+#include <eventuino/DigitalPinSource.h>
+#include "../../src/hal/EventuinoHal.h"
+
+using namespace eventuino;
+
+// Presses per work item handed to a thread
+#define CHUNK_PRESSES 100
+
+struct Options {
+  int presses = 2000;
+  std::vector<int> delays = { 1, 2, 3, 5, 8, 10, 15, 20, 30, 50, 75 };
+  std::vector<DigitalPinSource::debounceMode_t> modes = {
+    DigitalPinSource::DEBOUNCE_STABLE,
+    DigitalPinSource::DEBOUNCE_EAGER,
+    DigitalPinSource::DEBOUNCE_INTEGRATOR
+  };
+  int minBounces = 2;
+  int maxBounces = 8;
+  int bounceMicros = 300;
+  int bounceWindowMs = 5;
+  double glitchRate = 0;
+  int glitchMicros = 50;
+  int minHoldMs = 40;
+  int maxHoldMs = 400;
+  int pollMicros = 250;
+  double acceptablePercent = 0;
+  int threads = 0;
+  unsigned seed = 1;
+};
+
+Options options;
+
+// Virtual time, per thread, behind EventuinoHal::millis()
+thread_local uint64_t simMicros = 0;
+thread_local uint8_t simLevel = EventuinoHal::HIGH_STATE;
+
+unsigned long simMillis() {
+  return simMicros / 1000;
+}
+
+uint8_t simRead(uint8_t) {
+  return simLevel;
+}
+
+void simSetup(uint8_t) {}
+
+struct Candidate {
+  DigitalPinSource::debounceMode_t mode;
+  int delayMs;
+  std::mutex lock;
+  long extra = 0;
+  long missed = 0;
+  std::vector<uint32_t> pressMicros;
+  std::vector<uint32_t> releaseMicros;
+};
+
+// What one press cycle saw
+struct CycleEvents {
+  int presses = 0;
+  int releases = 0;
+  uint64_t firstPress = 0;
+  uint64_t firstRelease = 0;
+};
+
+// The real debounce logic, with the candidate's delay in place of the
+// static one shared by every source (which threads can't share)
+class SimulatedSwitch: public DigitalPinSource {
+  public:
+    SimulatedSwitch(DigitalPinSource::debounceMode_t mode, uint8_t delayMs):
+        DigitalPinSource(0, 0, simSetup, simRead), _delayMs(delayMs) {
+      setDebounceMode(mode);
+    }
+
+    void pollAt(CycleEvents* events) {
+      pollTimed(_delayMs, 0xFFFF, 0xFF, events);
+    }
+
+  protected:
+    void onChange(uint8_t, void* state) override {
+      CycleEvents* events = static_cast<CycleEvents*>(state);
+      if (isActive()) {
+        if (events->presses++ == 0) events->firstPress = simMicros;
+      } else {
+        if (events->releases++ == 0) events->firstRelease = simMicros;
+      }
+    }
+    void onLongHold(uint8_t, void*) override {}
+
+  private:
+    uint8_t _delayMs;
+};
+
+// A span of time during which the pin reads a level other than its base
+struct Span {
+  uint64_t start;
+  uint64_t end;
+};
+
+// Bounces starting at time, ending on the new level by the bounce window
+void addBounces(std::mt19937& rng, uint64_t time, std::vector<Span>& flips) {
+  std::uniform_int_distribution<int> count(options.minBounces, options.maxBounces);
+  std::exponential_distribution<double> length(1.0 / options.bounceMicros);
+  uint64_t windowEnd = time + options.bounceWindowMs * 1000ull;
+  uint64_t t = time;
+  for (int i = count(rng); i > 0; i--) {
+    // Settled at the new level a while, then briefly back at the old one
+    t += 1 + (uint64_t)length(rng);
+    uint64_t end = t + 1 + (uint64_t)length(rng);
+    if (end >= windowEnd) break;
+    flips.push_back({ t, end });
+    t = end;
+  }
+}
+
+// Simulates count press cycles for a candidate
+void simulate(Candidate& c, unsigned seed, int count) {
+  std::mt19937 rng(seed);
+  std::uniform_int_distribution<int> holdMs(options.minHoldMs, options.maxHoldMs);
+  std::exponential_distribution<double> glitchGap(options.glitchRate > 0 ? options.glitchRate / 1e6 : 1);
+
+  EventuinoHal::setClockSource(simMillis);
+  simMicros = 1000000;
+  simLevel = EventuinoHal::HIGH_STATE;
+  SimulatedSwitch pin(c.mode, c.delayMs);
+  pin.setup();
+
+  long extra = 0;
+  long missed = 0;
+  std::vector<uint32_t> pressMicros;
+  std::vector<uint32_t> releaseMicros;
+  std::vector<Span> flips;
+  uint64_t nextGlitch = options.glitchRate > 0 ? simMicros + (uint64_t)glitchGap(rng) : ~0ull;
+
+  for (int i = 0; i < count; i++) {
+    // Pressed (LOW) from pressAt to releaseAt, then released until end
+    uint64_t pressAt = simMicros;
+    uint64_t releaseAt = pressAt + holdMs(rng) * 1000ull;
+    uint64_t end = releaseAt + holdMs(rng) * 1000ull;
+    flips.clear();
+    addBounces(rng, pressAt, flips);
+    addBounces(rng, releaseAt, flips);
+    for (; nextGlitch < end; nextGlitch += 1 + (uint64_t)glitchGap(rng)) {
+      flips.push_back({ nextGlitch, nextGlitch + options.glitchMicros });
+    }
+    std::sort(flips.begin(), flips.end(),
+        [](const Span& a, const Span& b) { return a.start < b.start; });
+
+    CycleEvents events;
+    size_t next = 0;
+    for (; simMicros < end; simMicros += options.pollMicros) {
+      bool pressed = simMicros < releaseAt;
+      bool flipped = false;
+      while (next < flips.size() && flips[next].end <= simMicros) next++;
+      for (size_t f = next; f < flips.size() && flips[f].start <= simMicros; f++) {
+        if (simMicros < flips[f].end) flipped = !flipped;
+      }
+      simLevel = (pressed != flipped) ? EventuinoHal::LOW_STATE : EventuinoHal::HIGH_STATE;
+      pin.pollAt(&events);
+    }
+
+    if (events.presses == 0) {
+      missed++;
+    } else {
+      extra += events.presses - 1;
+      pressMicros.push_back(events.firstPress - pressAt);
+    }
+    if (events.releases > 0 && events.firstRelease >= releaseAt) {
+      releaseMicros.push_back(events.firstRelease - releaseAt);
+    }
+  }
+  EventuinoHal::setClockSource(nullptr);
+
+  std::lock_guard<std::mutex> guard(c.lock);
+  c.extra += extra;
+  c.missed += missed;
+  c.pressMicros.insert(c.pressMicros.end(), pressMicros.begin(), pressMicros.end());
+  c.releaseMicros.insert(c.releaseMicros.end(), releaseMicros.begin(), releaseMicros.end());
+}
+
+double percentileMs(std::vector<uint32_t>& micros, int p) {
+  if (micros.empty()) return 0;
+  std::sort(micros.begin(), micros.end());
+  size_t i = (micros.size() * p + 99) / 100;
+  return micros[i == 0 ? 0 : i - 1] / 1000.0;
+}
+
+const char* modeName(DigitalPinSource::debounceMode_t mode) {
+  return mode == DigitalPinSource::DEBOUNCE_STABLE ? "stable" :
+      mode == DigitalPinSource::DEBOUNCE_EAGER ? "eager" : "integrator";
+}
+
+bool parseRange(const char* arg, int& min, int& max) {
+  if (sscanf(arg, "%d-%d", &min, &max) == 2) return min >= 0 && min <= max;
+  if (sscanf(arg, "%d", &min) == 1) {
+    max = min;
+    return min >= 0;
+  }
+  return false;
+}
+
+bool parseOptions(int argc, char** argv) {
+  int opt;
+  while ((opt = getopt(argc, argv, "n:d:m:b:u:w:e:g:t:p:r:j:s:")) != -1) {
+    switch (opt) {
+      case 'n': options.presses = atoi(optarg); break;
+      case 'u': options.bounceMicros = atoi(optarg); break;
+      case 'w': options.bounceWindowMs = atoi(optarg); break;
+      case 'e': options.glitchRate = atof(optarg); break;
+      case 'g': options.glitchMicros = atoi(optarg); break;
+      case 'p': options.pollMicros = atoi(optarg); break;
+      case 'r': options.acceptablePercent = atof(optarg); break;
+      case 'j': options.threads = atoi(optarg); break;
+      case 's': options.seed = strtoul(optarg, nullptr, 10); break;
+      case 'b':
+        if (!parseRange(optarg, options.minBounces, options.maxBounces)) return false;
+        break;
+      case 't':
+        if (!parseRange(optarg, options.minHoldMs, options.maxHoldMs)) return false;
+        break;
+      case 'd': {
+        options.delays.clear();
+        char* list = strdup(optarg);
+        for (char* d = strtok(list, ","); d; d = strtok(nullptr, ",")) {
+          options.delays.push_back(atoi(d));
+        }
+        free(list);
+        break;
+      }
+      case 'm':
+        if (strcmp(optarg, "all") == 0) break;
+        options.modes.clear();
+        if (strcmp(optarg, "stable") == 0) {
+          options.modes.push_back(DigitalPinSource::DEBOUNCE_STABLE);
+        } else if (strcmp(optarg, "eager") == 0) {
+          options.modes.push_back(DigitalPinSource::DEBOUNCE_EAGER);
+        } else if (strcmp(optarg, "integrator") == 0) {
+          options.modes.push_back(DigitalPinSource::DEBOUNCE_INTEGRATOR);
+        } else {
+          return false;
+        }
+        break;
+      default:
+        return false;
+    }
+  }
+  for (int d : options.delays) {
+    if (d < 1 || d > 255) return false;
+  }
+  return options.presses > 0 && !options.delays.empty() && options.bounceMicros > 0 &&
+      options.pollMicros > 0 && options.minHoldMs > 0 && options.glitchRate >= 0;
+}
+
+int main(int argc, char** argv) {
+  if (!parseOptions(argc, argv)) {
+    fprintf(stderr, "usage: %s [-n count] [-d ms,ms,...] [-m stable|eager|integrator|all]"
+        " [-b min-max] [-u micros] [-w ms] [-e rate] [-g micros] [-t min-max]"
+        " [-p micros] [-r percent] [-j threads] [-s seed]\n", argv[0]);
+    return 2;
+  }
+
+  std::vector<Candidate*> candidates;
+  for (DigitalPinSource::debounceMode_t mode : options.modes) {
+    int lastDelay = 0;
+    for (int delay : options.delays) {
+      if (mode == DigitalPinSource::DEBOUNCE_INTEGRATOR) {
+        // Samples are whole ms apart, so the delay acts as a multiple of
+        // 8ms; try each distinct one once, under the delay it acts as
+        delay = std::max(8, delay & ~7);
+        if (delay == lastDelay) continue;
+        lastDelay = delay;
+      }
+      Candidate* c = new Candidate();
+      c->mode = mode;
+      c->delayMs = delay;
+      candidates.push_back(c);
+    }
+  }
+
+  // Work items of CHUNK_PRESSES presses, each with its own seed, so the
+  // results don't depend on the number of threads
+  int chunks = (options.presses + CHUNK_PRESSES - 1) / CHUNK_PRESSES;
+  int items = (int)candidates.size() * chunks;
+  std::atomic<int> nextItem(0);
+  int threadCount = options.threads > 0 ? options.threads :
+      std::max(1u, std::thread::hardware_concurrency());
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threadCount; t++) {
+    workers.emplace_back([&]() {
+      for (int item = nextItem++; item < items; item = nextItem++) {
+        int chunk = item % chunks;
+        int count = std::min(CHUNK_PRESSES, options.presses - chunk * CHUNK_PRESSES);
+        simulate(*candidates[item / chunks], options.seed * 1000003u + chunk, count);
+      }
+    });
+  }
+  for (std::thread& w : workers) w.join();
+
+  printf("%d presses per candidate, %d-%d bounces of ~%dus within %dms, "
+      "%.1f glitches/s of %dus, polled every %dus, %d threads\n\n",
+      options.presses, options.minBounces, options.maxBounces, options.bounceMicros,
+      options.bounceWindowMs, options.glitchRate, options.glitchMicros,
+      options.pollMicros, threadCount);
+  printf("mode        debounce   errors    extra  missed   press p50/p99   release p99\n");
+  Candidate* best = nullptr;
+  double bestP99 = 0;
+  for (Candidate* c : candidates) {
+    double errors = 100.0 * (c->extra + c->missed) / options.presses;
+    double pressP50 = percentileMs(c->pressMicros, 50);
+    double pressP99 = percentileMs(c->pressMicros, 99);
+    double releaseP99 = percentileMs(c->releaseMicros, 99);
+    printf("%-10s  %5dms  %6.2f%%  %7ld  %6ld  %6.1f/%5.1fms  %9.1fms\n",
+        modeName(c->mode), c->delayMs, errors, c->extra, c->missed,
+        pressP50, pressP99, releaseP99);
+    double worstP99 = std::max(pressP99, releaseP99);
+    if (errors <= options.acceptablePercent && (best == nullptr || worstP99 < bestP99)) {
+      best = c;
+      bestP99 = worstP99;
+    }
+  }
+
+  if (best == nullptr) {
+    printf("\nNo candidate within %.2f%% errors\n", options.acceptablePercent);
+  } else {
+    printf("\nRecommended: setDebounceMode(DigitalPinSource::DEBOUNCE_%s), "
+        "setDebounceDelayMs(%d); p99 latency %.1fms\n",
+        best->mode == DigitalPinSource::DEBOUNCE_STABLE ? "STABLE" :
+        best->mode == DigitalPinSource::DEBOUNCE_EAGER ? "EAGER" : "INTEGRATOR",
+        best->delayMs, bestP99);
+  }
+  for (Candidate* c : candidates) delete c;
+  return best == nullptr ? 1 : 0;
+}
@@ -0,0 +1,201 @@
+// Bare-metal AVR press-to-callback latency harness, for an ATmega2560 on
+// real hardware or in SimulIDE. A timer interrupt presses and releases
+// a stimulus pin at randomized times, asynchronously to the poll loop,
+// while Eventuino polls the measured Button alongside background
+// sources and load. Once LATENCY_SAMPLES presses have been reported,
+// the latency distribution is printed on Uart0.
+//
+// Wiring: STIMULUS_PIN (PL6) to MEASURED_PIN (PL7). MARKER_PIN (PL5)
+// toggles in every onPressed, so a scope or logic analyzer on PL6 and
+// PL5 - or SimulIDE's probes - captures the same latencies externally,
+// from the stimulus's falling edge to the marker's next edge.
+//
+// Build with ./build.sh [-s], overriding any of the LATENCY_ settings
+// below with -D flags after --.
+
+#include <avr/interrupt.h>
+#include <avr/io.h>
+#include <stdlib.h>
+#include <util/delay.h>
+#include <BareMetalHAL.h>
+#include <Eventuino.h>
+#include <eventuino/Button.h>
+#include "../../src/hal/EventuinoHal.h"
+
+using namespace eventuino;
+using namespace BareMetalHAL;
+
+// Background Buttons polled with the measured one (up to 32)
+#ifndef LATENCY_SOURCES
+#define LATENCY_SOURCES 8
+#endif
+
+// Time each background callback takes
+#ifndef LATENCY_CALLBACK_US
+#define LATENCY_CALLBACK_US 0
+#endif
+
+// Extra load on every poll, e.g. other work in the main loop
+#ifndef LATENCY_LOAD_US
+#define LATENCY_LOAD_US 0
+#endif
+
+#ifndef LATENCY_DEBOUNCE_MS
+#define LATENCY_DEBOUNCE_MS 10
+#endif
+
+// DigitalPinSource::DEBOUNCE_STABLE, _EAGER or _INTEGRATOR
+#ifndef LATENCY_DEBOUNCE_MODE
+#define LATENCY_DEBOUNCE_MODE DigitalPinSource::DEBOUNCE_STABLE
+#endif
+
+// Presses to measure (2 bytes of RAM each)
+#ifndef LATENCY_SAMPLES
+#define LATENCY_SAMPLES 200
+#endif
+
+#define STIMULUS_PIN pin(Port::L, 6)
+#define MEASURED_PIN pin(Port::L, 7)
+#define MARKER_PIN pin(Port::L, 5)
+
+// Timer3 ticks are 4us (16MHz / 64)
+#define TICKS_PER_MS 250
+
+Eventuino evt;
+Button measured(MEASURED_PIN, 0xFF);
+
+volatile uint32_t backgroundBits = 0xFFFFFFFF;  // all released (HIGH)
+volatile uint32_t pressMicros = 0;
+volatile bool pressed = false;
+volatile bool awaitingCallback = false;
+volatile uint16_t lfsr = 0xACE1;
+
+uint16_t latencies[LATENCY_SAMPLES];
+volatile uint16_t sampleCount = 0;
+
+uint8_t backgroundRead(uint8_t pin) {
+  return (backgroundBits >> pin) & 0x01;
+}
+
+void backgroundCallback(uint8_t, void*) {
+  _delay_us(LATENCY_CALLBACK_US);
+}
+
+class LoadSource: public EventSource {
+  public:
+    void setup() override {};
+    void poll(void*) override {
+      _delay_us(LATENCY_LOAD_US);
+    }
+};
+
+Button* background[LATENCY_SOURCES > 0 ? LATENCY_SOURCES : 1];
+LoadSource load;
+
+void measuredPressed(uint8_t, void*) {
+  uint8_t saved = EventuinoHal::enterCritical();
+  uint32_t latency = micros() - pressMicros;
+  awaitingCallback = false;
+  EventuinoHal::exitCritical(saved);
+
+  digitalWrite(MARKER_PIN, digitalRead(MARKER_PIN) == HIGH ? LOW : HIGH);
+  if (sampleCount < LATENCY_SAMPLES) {
+    latencies[sampleCount++] = latency > 0xFFFF ? 0xFFFF : latency;
+  }
+}
+
+uint16_t nextRandom() {
+  uint16_t bit = ((lfsr >> 0) ^ (lfsr >> 2) ^ (lfsr >> 3) ^ (lfsr >> 5)) & 1;
+  lfsr = (lfsr >> 1) | (bit << 15);
+  return lfsr;
+}
+
+// Fires at randomized intervals of 2 to 4 debounce delays: flips a
+// background pin, then presses the stimulus pin, or releases it once
+// the press has been reported
+ISR(TIMER3_COMPA_vect) {
+  uint16_t r = nextRandom();
+#if LATENCY_SOURCES > 0
+  backgroundBits ^= 1UL << (r % LATENCY_SOURCES);
+#endif
+  if (!pressed) {
+    if (sampleCount < LATENCY_SAMPLES) {
+      digitalWrite(STIMULUS_PIN, LOW);
+      pressMicros = micros();
+      pressed = true;
+      awaitingCallback = true;
+    }
+  } else if (!awaitingCallback) {
+    digitalWrite(STIMULUS_PIN, HIGH);
+    pressed = false;
+  }
+  uint16_t minTicks = 2u * LATENCY_DEBOUNCE_MS * TICKS_PER_MS;
+  OCR3A = minTicks + r % minTicks;
+}
+
+void printNumber(const char* label, uint32_t n) {
+  char buffer[11];
+  Uart0::print(label);
+  Uart0::print(ultoa(n, buffer, 10));
+}
+
+int main() {
+  Uart0::begin(9600);
+  timingInit();
+
+  pinMode(STIMULUS_PIN, OUTPUT);
+  digitalWrite(STIMULUS_PIN, HIGH);
+  pinMode(MARKER_PIN, OUTPUT);
+  digitalWrite(MARKER_PIN, LOW);
+
+  DigitalPinSource::setDebounceDelayMs(LATENCY_DEBOUNCE_MS);
+  measured.setDebounceMode(LATENCY_DEBOUNCE_MODE);
+  measured.onPressed = measuredPressed;
+  evt.addEventSource(&measured);
+  for (uint8_t i = 0; i < LATENCY_SOURCES; i++) {
+    background[i] = new Button(i, i, [](uint8_t) {}, backgroundRead);
+    background[i]->setDebounceMode(LATENCY_DEBOUNCE_MODE);
+    background[i]->onPressed = backgroundCallback;
+    background[i]->onReleased = backgroundCallback;
+    evt.addEventSource(background[i]);
+  }
+  evt.addEventSource(&load);
+  evt.begin();
+
+  // Timer3 in CTC mode, /64 prescaler
+  TCCR3A = 0;
+  TCCR3B = (1 << WGM32) | (1 << CS31) | (1 << CS30);
+  OCR3A = 2u * LATENCY_DEBOUNCE_MS * TICKS_PER_MS;
+  TIMSK3 = (1 << OCIE3A);
+  sei();
+
+  while (sampleCount < LATENCY_SAMPLES) {
+    evt.poll();
+  }
+  TIMSK3 = 0;
+
+  // Insertion sort; fine for a few hundred samples, once
+  for (uint16_t i = 1; i < sampleCount; i++) {
+    uint16_t v = latencies[i];
+    uint16_t j = i;
+    while (j > 0 && latencies[j - 1] > v) {
+      latencies[j] = latencies[j - 1];
+      j--;
+    }
+    latencies[j] = v;
+  }
+
+  printNumber("sources ", LATENCY_SOURCES);
+  printNumber(" + 1, callback ", LATENCY_CALLBACK_US);
+  printNumber("us, load ", LATENCY_LOAD_US);
+  printNumber("us, debounce ", LATENCY_DEBOUNCE_MS);
+  Uart0::println("ms");
+  printNumber("latency us: min ", latencies[0]);
+  printNumber("  p50 ", latencies[((uint32_t)sampleCount * 50 + 99) / 100 - 1]);
+  printNumber("  p99 ", latencies[((uint32_t)sampleCount * 99 + 99) / 100 - 1]);
+  printNumber("  max ", latencies[sampleCount - 1]);
+  Uart0::println("");
+
+  while (true) {}
+  return 0;
+}
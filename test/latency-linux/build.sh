@@ -0,0 +1,71 @@
+#!/bin/bash
+
+# Usage:
+#   ./build.sh                  Build the host-native latency harness
+#   ./build.sh -r [-- args]     Build it, then run it with the given args
+#
+# Builds Eventuino with -DNO_ARDUINO -DHAL_LINUX, like
+# ../test-suite-linux/build.sh. Pins are virtual - edges are injected
+# through pipes standing in for GPIO line fds - while latency is timed
+# on the real CLOCK_MONOTONIC, so the numbers include the real cost of
+# polling on this machine. See latency-linux.cpp for the options.
+
+set -euo pipefail
+
+RUN=false
+while getopts "r" opt; do
+  case $opt in
+    r) RUN=true ;;
+  esac
+done
+shift $((OPTIND - 1))
+[ "${1:-}" = "--" ] && shift
+
+CXX="${CXX:-g++}"
+AR="${AR:-ar}"
+DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+BUILD_DIR="$DIR/build"
+OBJ_DIR="$BUILD_DIR/obj"
+
+CFLAGS=(-std=gnu++11 -Wall -Wextra -O2 -pthread -DNO_ARDUINO -DHAL_LINUX -I "$DIR/../../src")
+
+mkdir -p "$OBJ_DIR"
+
+# build_archive <name> <src-root>
+#
+# Compiles every *.cpp found (recursively) under <src-root> and archives
+# the resulting objects into $BUILD_DIR/lib<name>.a. Prints the archive
+# path.
+build_archive() {
+  local name="$1"
+  local src_root="$2"
+  local objdir="$OBJ_DIR/$name"
+  mkdir -p "$objdir"
+
+  local objs=()
+  local src rel obj
+  while IFS= read -r -d '' src; do
+    rel="${src#"$src_root"/}"
+    obj="$objdir/${rel//\//_}.o"
+    "$CXX" "${CFLAGS[@]}" -c "$src" -o "$obj"
+    objs+=("$obj")
+  done < <(find "$src_root" -name '*.cpp' -print0 | sort -z)
+
+  local archive="$BUILD_DIR/lib${name}.a"
+  rm -f "$archive"
+  "$AR" rcs "$archive" "${objs[@]}"
+  echo "$archive"
+}
+
+build_archive eventuino "$DIR/../../src" >/dev/null
+
+"$CXX" "${CFLAGS[@]}" \
+  "$DIR/latency-linux.cpp" \
+  -o "$BUILD_DIR/latency-linux" \
+  -L "$BUILD_DIR" -leventuino
+
+echo "Built $BUILD_DIR/latency-linux"
+
+if $RUN; then
+  "$BUILD_DIR/latency-linux" "$@"
+fi
@@ -0,0 +1,259 @@
+// Host-native press-to-callback latency harness for the -DHAL_LINUX
+// build. Presses are injected into a virtual pin (a pipe standing in for
+// a GPIO line fd) at known times, while Eventuino polls the measured
+// Button alongside a configurable background load. Each press's latency
+// is measured from the edge's timestamp to onPressed, on the real
+// CLOCK_MONOTONIC, and the distribution is reported at the end.
+//
+// Build and run with ./build.sh -r -- [options]
+//
+//   -n COUNT   Background Buttons polled with the measured one (8)
+//   -a RATE    Background presses and releases per second, in total (100)
+//   -c MICROS  Time each background callback takes (0)
+//   -l MICROS  Extra load on every poll, e.g. other work in loop() (0)
+//   -d MS      Debounce delay (10)
+//   -m MODE    Debounce mode: stable, eager or integrator (stable)
+//   -q SIZE    Defer events through an EventQueue of this size (off)
+//   -s COUNT   Presses to measure (200)
+//   -g MICROS  Exit with status 1 if the p99 latency exceeds this
+//
+// With -m stable, a press is only reported once the pin has been steady
+// for the debounce delay, so latencies start at about that delay; the
+// remainder is the cost of polling.
+
+#include <linux/gpio.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <thread>
+#include <vector>
+#include <Eventuino.h>
+#include <EventQueue.h>
+#include <eventuino/Button.h>
+#include "../../src/hal/EventuinoHal.h"
+
+using namespace eventuino;
+
+#define MEASURED_PIN 0
+#define MEASURED_VALUE 0xFF
+
+// Eventuino counts its sources in a uint8_t; leave room for the
+// measured Button and the load source
+#define MAX_BACKGROUND 250
+
+struct Options {
+  int backgroundCount = 8;
+  int backgroundRate = 100;
+  int callbackMicros = 0;
+  int loadMicros = 0;
+  int debounceMs = 10;
+  DigitalPinSource::debounceMode_t mode = DigitalPinSource::DEBOUNCE_STABLE;
+  int queueSize = 0;
+  int samples = 200;
+  long gateMicros = 0;
+};
+
+Options options;
+int edgePipe[2] = { -1, -1 };
+std::atomic<uint8_t> backgroundLevels[MAX_BACKGROUND + 1];
+std::atomic<bool> running(true);
+std::atomic<int> pressesSeen(0);
+std::vector<long> latencies;
+
+uint64_t monotonicNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+void spinMicros(int micros) {
+  if (micros <= 0) return;
+  uint64_t until = monotonicNs() + micros * 1000ull;
+  while (monotonicNs() < until) {}
+}
+
+void sleepUntilNs(uint64_t ns) {
+  struct timespec ts;
+  ts.tv_sec = ns / 1000000000ull;
+  ts.tv_nsec = ns % 1000000000ull;
+  clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr);
+}
+
+// Writes a synthetic kernel edge event, stamped with the time it's sent
+void writeEdge(bool rising) {
+  struct gpio_v2_line_event event;
+  memset(&event, 0, sizeof(event));
+  event.timestamp_ns = monotonicNs();
+  event.id = rising ? GPIO_V2_LINE_EVENT_RISING_EDGE : GPIO_V2_LINE_EVENT_FALLING_EDGE;
+  event.offset = MEASURED_PIN;
+  if (write(edgePipe[1], &event, sizeof(event)) != sizeof(event)) {
+    perror("write edge");
+  }
+}
+
+uint8_t backgroundRead(uint8_t pin) {
+  return backgroundLevels[pin].load(std::memory_order_relaxed);
+}
+
+// Burns the -l load on every poll
+class LoadSource: public EventSource {
+  public:
+    void setup() override {};
+    void poll(void*) override {
+      spinMicros(options.loadMicros);
+    }
+};
+
+// Presses the measured pin at randomized intervals, each time waiting
+// for its onPressed before releasing it again
+void injectPresses() {
+  std::mt19937 rng(42);
+  std::uniform_int_distribution<int> gapMs(options.debounceMs * 2, options.debounceMs * 4 + 10);
+  for (int i = 0; i < options.samples && running; i++) {
+    sleepUntilNs(monotonicNs() + gapMs(rng) * 1000000ull);
+    writeEdge(false);
+    uint64_t timeout = monotonicNs() + 2000000000ull;
+    while (pressesSeen.load() <= i && monotonicNs() < timeout) {
+      sleepUntilNs(monotonicNs() + 100000ull);
+    }
+    sleepUntilNs(monotonicNs() + gapMs(rng) * 1000000ull);
+    writeEdge(true);
+  }
+  sleepUntilNs(monotonicNs() + (options.debounceMs * 2 + 10) * 1000000ull);
+  running = false;
+}
+
+// Toggles random background pins at the -a rate
+void injectBackground() {
+  if (options.backgroundCount == 0 || options.backgroundRate <= 0) return;
+  std::mt19937 rng(7);
+  std::uniform_int_distribution<int> pin(1, options.backgroundCount);
+  uint64_t gapNs = 1000000000ull / options.backgroundRate;
+  uint64_t next = monotonicNs();
+  while (running) {
+    next += gapNs;
+    sleepUntilNs(next);
+    uint8_t p = pin(rng);
+    backgroundLevels[p].store(backgroundLevels[p].load() ^ 1);
+  }
+}
+
+long percentile(const std::vector<long>& sorted, int p) {
+  if (sorted.empty()) return 0;
+  size_t i = (sorted.size() * p + 99) / 100;
+  return sorted[i == 0 ? 0 : i - 1];
+}
+
+bool parseOptions(int argc, char** argv) {
+  int opt;
+  while ((opt = getopt(argc, argv, "n:a:c:l:d:m:q:s:g:")) != -1) {
+    switch (opt) {
+      case 'n': options.backgroundCount = atoi(optarg); break;
+      case 'a': options.backgroundRate = atoi(optarg); break;
+      case 'c': options.callbackMicros = atoi(optarg); break;
+      case 'l': options.loadMicros = atoi(optarg); break;
+      case 'd': options.debounceMs = atoi(optarg); break;
+      case 'q': options.queueSize = atoi(optarg); break;
+      case 's': options.samples = atoi(optarg); break;
+      case 'g': options.gateMicros = atol(optarg); break;
+      case 'm':
+        if (strcmp(optarg, "stable") == 0) {
+          options.mode = DigitalPinSource::DEBOUNCE_STABLE;
+        } else if (strcmp(optarg, "eager") == 0) {
+          options.mode = DigitalPinSource::DEBOUNCE_EAGER;
+        } else if (strcmp(optarg, "integrator") == 0) {
+          options.mode = DigitalPinSource::DEBOUNCE_INTEGRATOR;
+        } else {
+          return false;
+        }
+        break;
+      default:
+        return false;
+    }
+  }
+  return options.backgroundCount >= 0 && options.backgroundCount <= MAX_BACKGROUND &&
+      options.debounceMs > 0 && options.debounceMs < 256 && options.samples > 0 &&
+      options.queueSize >= 0 && options.queueSize < 256;
+}
+
+int main(int argc, char** argv) {
+  if (!parseOptions(argc, argv)) {
+    fprintf(stderr, "usage: %s [-n count] [-a rate] [-c micros] [-l micros] [-d ms]"
+        " [-m stable|eager|integrator] [-q size] [-s count] [-g micros]\n", argv[0]);
+    return 2;
+  }
+  if (pipe(edgePipe) != 0) {
+    perror("pipe");
+    return 2;
+  }
+  EventuinoHal::attachEdgeSource(MEASURED_PIN, edgePipe[0], EventuinoHal::HIGH_STATE);
+  DigitalPinSource::setDebounceDelayMs(options.debounceMs);
+  latencies.reserve(options.samples);
+
+  Eventuino evt;
+  Button measured(MEASURED_PIN, MEASURED_VALUE);
+  measured.setDebounceMode(options.mode);
+  measured.onPressed = [](uint8_t, void*) {
+    uint64_t now = monotonicNs();
+    latencies.push_back((long)((now - EventuinoHal::lastEdgeNs(MEASURED_PIN)) / 1000));
+    pressesSeen++;
+  };
+  evt.addEventSource(&measured);
+
+  std::vector<Button> background;
+  background.reserve(options.backgroundCount);
+  for (int i = 1; i <= options.backgroundCount; i++) {
+    backgroundLevels[i] = EventuinoHal::HIGH_STATE;
+    background.emplace_back(i, i, [](uint8_t) {}, backgroundRead);
+    background.back().setDebounceMode(options.mode);
+    background.back().onPressed = [](uint8_t, void*) { spinMicros(options.callbackMicros); };
+    background.back().onReleased = [](uint8_t, void*) { spinMicros(options.callbackMicros); };
+  }
+  for (Button& b : background) evt.addEventSource(&b);
+  LoadSource load;
+  evt.addEventSource(&load);
+
+  EventQueue queue(options.queueSize > 0 ? options.queueSize : 1);
+  if (options.queueSize > 0) evt.setEventQueue(&queue);
+  evt.begin();
+
+  std::thread presses(injectPresses);
+  std::thread backgroundPresses(injectBackground);
+  uint64_t polls = 0;
+  uint64_t start = monotonicNs();
+  while (running) {
+    evt.poll();
+    polls++;
+  }
+  uint64_t elapsedNs = monotonicNs() - start;
+  presses.join();
+  backgroundPresses.join();
+  evt.setEventQueue(nullptr);
+
+  std::vector<long> sorted = latencies;
+  std::sort(sorted.begin(), sorted.end());
+  printf("sources %d + 1, background %d/s, callback %dus, load %dus, debounce %dms (%s)%s\n",
+      options.backgroundCount, options.backgroundRate, options.callbackMicros,
+      options.loadMicros, options.debounceMs,
+      options.mode == DigitalPinSource::DEBOUNCE_STABLE ? "stable" :
+      options.mode == DigitalPinSource::DEBOUNCE_EAGER ? "eager" : "integrator",
+      options.queueSize > 0 ? ", queued" : "");
+  printf("mean poll %.2fus over %llu polls\n",
+      polls ? elapsedNs / 1000.0 / polls : 0.0, (unsigned long long)polls);
+  printf("presses %zu of %d\n", sorted.size(), options.samples);
+  if (sorted.empty()) return 1;
+  printf("latency us: min %ld  p50 %ld  p99 %ld  max %ld\n",
+      sorted.front(), percentile(sorted, 50), percentile(sorted, 99), sorted.back());
+
+  if ((int)sorted.size() < options.samples) return 1;
+  if (options.gateMicros > 0 && percentile(sorted, 99) > options.gateMicros) {
+    printf("FAILED: p99 over %ldus\n", options.gateMicros);
+    return 1;
+  }
+  return 0;
+}
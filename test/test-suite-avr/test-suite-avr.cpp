@@ -6,6 +6,8 @@
 // Arduino-branch suite does.
 
 #include <util/delay.h>
+#include <avr/pgmspace.h>
+#include <string.h>
 #include <BareMetalHAL.h>
 #include <Eventuino.h>
 #include <TestTool.h>
@@ -195,6 +197,1152 @@ void testIntervalTimer(TestInvocation* t) {
   t->verify(capture.callCount == 3, F("onExpired called by cancelled timer"));
 }
 
+void testRoutingTable(TestInvocation* t) {
+  t->setName(F("Routing table dispatches unhandled events"));
+  Eventuino evt;
+  auto onRouted = [](uint8_t value, void* state = nullptr) {
+    CallbackCapture* c = static_cast<CallbackCapture*>(state);
+    c->value = value;
+    c->callCount++;
+  };
+  auto onOwn = [](uint8_t, void* state = nullptr) {
+    CallbackCapture* c = static_cast<CallbackCapture*>(state);
+    c->callCount += 10;
+  };
+  // Rows for values 4 and 5, columns CHANGE, ACTIVATE, DEACTIVATE
+  const EventSource::eventuinoCallback_t handlers[] = {
+    0, onRouted, onRouted,
+    0, onRouted, 0
+  };
+  EventRoutingTable table = { 4, 2, 3, handlers };
+  evt.setRoutingTable(&table);
+
+  CallbackCapture capture;
+  DigitalPinSource dps = helper.digitalPinSrc(1, 4);
+  helper.doBouncyActivate(&dps, &capture);
+  t->verify(capture.callCount == 1, F("Activate should have been routed"));
+  t->verify(capture.value == 4, F("Expected value = 4"));
+  helper.doBouncyDeactivate(&dps, &capture);
+  t->verify(capture.callCount == 2, F("Deactivate should have been routed"));
+
+  Button btn = helper.buttonSrc(1, 5);
+  btn.onPressed = onOwn;
+  helper.doBouncyActivate(&btn, &capture);
+  t->verify(capture.callCount == 12, F("Button's own callback should win"));
+  helper.doBouncyDeactivate(&btn, &capture);
+  t->verify(capture.callCount == 12, F("No handler for value 5 DEACTIVATE"));
+
+  Button other = helper.buttonSrc(1, 9);
+  helper.doBouncyActivate(&other, &capture);
+  t->verify(capture.callCount == 12, F("Value 9 is outside the table"));
+
+  evt.setRoutingTable(nullptr);
+}
+
+void testBasicButtonTiming(TestInvocation* t) {
+  t->setName(F("BasicButton compile-time timing"));
+  Button btn = helper.buttonSrc(1, 7); // static long hold delay is 50ms
+  BasicButton<5, 30, 8> basic = helper.basicButtonSrc(1, 7);
+  CallbackCapture capture;
+  auto onLongPress = [](uint8_t value, void* state = nullptr) {
+    CallbackCapture* c = static_cast<CallbackCapture*>(state);
+    c->value = value;
+    c->callCount++;
+  };
+  btn.onLongPress = onLongPress;
+  basic.onLongPress = onLongPress;
+
+  helper.doBouncyActivate(&basic, &capture);
+  t->verify(basic.isPressed(), F("Should be active"));
+  _delay_ms(32);
+  helper.doPoll(&basic, &capture);
+  t->verify(basic.isLongPressed(), F("Should be long pressed after 30ms"));
+  t->verify(capture.callCount == 1, F("onLongPress should have been called"));
+
+  helper.doBouncyActivate(&btn, &capture);
+  _delay_ms(32);
+  helper.doPoll(&btn, &capture);
+  t->verify(!btn.isLongPressed(), F("Static delay should still be 50ms"));
+  t->verify(capture.callCount == 1, F("onLongPress should not have been called"));
+}
+
+void testDebounceModes(TestInvocation* t) {
+  t->setName(F("Eager and integrator debounce modes"));
+  CallbackCapture capture;
+  auto onChange = [](uint8_t value, void* state = nullptr) {
+    CallbackCapture* c = static_cast<CallbackCapture*>(state);
+    c->value = value;
+    c->callCount++;
+  };
+
+  DigitalPinSource eager = helper.digitalPinSrc(1, 8);
+  eager.setDebounceMode(DigitalPinSource::DEBOUNCE_EAGER);
+  eager.onChangeState = onChange;
+  helper.digitalReadValue = EventuinoHal::LOW_STATE;
+  helper.doPoll(&eager, &capture);
+  t->verify(capture.callCount == 1, F("First edge should be reported at once"));
+  helper.digitalReadValue = EventuinoHal::HIGH_STATE;
+  helper.doPoll(&eager, &capture);
+  helper.digitalReadValue = EventuinoHal::LOW_STATE;
+  helper.doPoll(&eager, &capture);
+  t->verify(capture.callCount == 1, F("Bounces in the lockout should be ignored"));
+  _delay_ms(12);
+  helper.doPoll(&eager, &capture);
+  helper.digitalReadValue = EventuinoHal::HIGH_STATE;
+  helper.doPoll(&eager, &capture);
+  t->verify(capture.callCount == 2, F("Release should be reported at once"));
+
+  capture.callCount = 0;
+  DigitalPinSource integrator = helper.digitalPinSrc(1, 9);
+  integrator.setDebounceMode(DigitalPinSource::DEBOUNCE_INTEGRATOR);
+  integrator.onChangeState = onChange;
+  helper.digitalReadValue = EventuinoHal::LOW_STATE;
+  for (uint8_t i = 0; i < 7; i++) {
+    helper.doPoll(&integrator, &capture);
+    _delay_ms(2);
+  }
+  helper.digitalReadValue = EventuinoHal::HIGH_STATE; // glitch
+  helper.doPoll(&integrator, &capture);
+  _delay_ms(2);
+  helper.digitalReadValue = EventuinoHal::LOW_STATE;
+  for (uint8_t i = 0; i < 7; i++) {
+    helper.doPoll(&integrator, &capture);
+    _delay_ms(2);
+  }
+  t->verify(capture.callCount == 0, F("Should wait for 8 agreeing samples"));
+  helper.doPoll(&integrator, &capture);
+  t->verify(capture.callCount == 1, F("8 agreeing samples should be reported"));
+  t->verify(capture.value == 9, F("Expected value = 9"));
+}
+
+struct GroupCapture {
+  uint8_t changedMask = 0;
+  uint8_t stateMask = 0;
+  uint8_t callCount = 0;
+};
+
+void testDigitalPinGroup(TestInvocation* t) {
+  t->setName(F("DigitalPinGroup coalesces changes"));
+  DigitalPinSource a = helper.digitalPinSrc(1, 1);
+  DigitalPinSource b = helper.digitalPinSrc(2, 2);
+  DigitalPinGroup8 group;
+  group.addSource(&a);
+  group.addSource(&b);
+  GroupCapture capture;
+  auto onGroupChange = [](uint8_t changedMask, uint8_t stateMask, void* state = nullptr) {
+    GroupCapture* c = static_cast<GroupCapture*>(state);
+    c->changedMask = changedMask;
+    c->stateMask = stateMask;
+    c->callCount++;
+  };
+  group.onGroupChange = onGroupChange;
+
+  helper.doSetup(&group);
+  t->verify(helper.didPinSetup, "Setup function should have been called");
+  helper.digitalReadValue = EventuinoHal::LOW_STATE; // both members share the helper's pin
+  helper.doPoll(&group, &capture);
+  _delay_ms(15);
+  helper.doPoll(&group, &capture);
+  t->verify(capture.callCount == 1, F("Should have been one group callback"));
+  t->verify(capture.changedMask == 0b11, F("Both sources should have changed"));
+  t->verify(capture.stateMask == 0b11, F("Both sources should be active"));
+  t->verify(group.stateMask() == 0b11, F("stateMask() should match"));
+  helper.doPoll(&group, &capture);
+  t->verify(capture.callCount == 1, F("No callback without a change"));
+  helper.digitalReadValue = EventuinoHal::HIGH_STATE;
+  helper.doPoll(&group, &capture);
+  _delay_ms(15);
+  helper.doPoll(&group, &capture);
+  t->verify(capture.callCount == 2, F("Should have been a second callback"));
+  t->verify(capture.changedMask == 0b11, F("Both sources should have changed"));
+  t->verify(capture.stateMask == 0, F("Both sources should be inactive"));
+}
+
+struct GestureCapture {
+  uint8_t value = 0;
+  uint8_t clicks = 0;
+  uint32_t mask = 0;
+  uint8_t callCount = 0;
+};
+
+void testGestureRecognizer(TestInvocation* t) {
+  t->setName(F("GestureRecognizer clicks and chords"));
+  Button a = helper.buttonSrc(1, 3);
+  Button b = helper.buttonSrc(2, 4);
+  GestureRecognizer single(20, 100, 30);
+  single.addButton(&a);
+  GestureCapture capture;
+  auto onClick = [](uint8_t value, uint8_t clicks, void* state = nullptr) {
+    GestureCapture* c = static_cast<GestureCapture*>(state);
+    c->value = value;
+    c->clicks = clicks;
+    c->callCount++;
+  };
+  auto onChord = [](uint8_t value, uint32_t mask, void* state = nullptr) {
+    GestureCapture* c = static_cast<GestureCapture*>(state);
+    c->value = value;
+    c->mask = mask;
+    c->callCount++;
+  };
+  single.onClick = onClick;
+
+  for (uint8_t i = 0; i < 2; i++) {
+    helper.doBouncyActivate(&a);
+    helper.doPoll(&single, &capture);
+    helper.doBouncyDeactivate(&a);
+    helper.doPoll(&single, &capture);
+  }
+  t->verify(capture.callCount == 0, F("Clicks should not be reported yet"));
+  _delay_ms(110);
+  helper.doPoll(&single, &capture);
+  t->verify(capture.callCount == 1, F("onClick should have been called"));
+  t->verify(capture.value == 3, F("Expected value = 3"));
+  t->verify(capture.clicks == 2, F("Expected a double-click"));
+
+  capture.callCount = 0;
+  GestureRecognizer chord(21, 100, 30);
+  chord.addButton(&a);
+  chord.addButton(&b);
+  chord.onClick = onClick;
+  chord.onChord = onChord;
+  helper.digitalReadValue = EventuinoHal::LOW_STATE; // both buttons share the helper's pin
+  helper.doPoll(&a);
+  helper.doPoll(&b);
+  _delay_ms(15);
+  helper.doPoll(&a);
+  helper.doPoll(&b);
+  helper.doPoll(&chord, &capture);
+  _delay_ms(35);
+  helper.doPoll(&chord, &capture);
+  t->verify(capture.callCount == 1, F("onChord should have been called"));
+  t->verify(capture.value == 21, F("Expected value = 21"));
+  t->verify(capture.mask == 0b11, F("Expected both buttons in the chord"));
+  helper.doBouncyDeactivate(&a);
+  helper.doBouncyDeactivate(&b);
+  helper.doPoll(&chord, &capture);
+  _delay_ms(110);
+  helper.doPoll(&chord, &capture);
+  t->verify(capture.callCount == 1, F("Chorded buttons should not click"));
+
+  // A second chord just past the first one's window, with no poll between
+  capture.callCount = 0;
+  Button c = helper.buttonSrc(3, 5);
+  Button d = helper.buttonSrc(4, 6);
+  GestureRecognizer chords(22, 100, 30);
+  chords.addButton(&a);
+  chords.addButton(&b);
+  chords.addButton(&c);
+  chords.addButton(&d);
+  chords.onChord = onChord;
+  helper.digitalReadValue = EventuinoHal::LOW_STATE;
+  helper.doPoll(&a);
+  helper.doPoll(&b);
+  _delay_ms(15);
+  helper.doPoll(&a);
+  helper.doPoll(&b);
+  helper.doPoll(&chords, &capture);
+  helper.doPoll(&c);
+  helper.doPoll(&d);
+  _delay_ms(35);
+  helper.doPoll(&c);
+  helper.doPoll(&d);
+  helper.doPoll(&chords, &capture);
+  t->verify(capture.callCount == 1 && capture.mask == 0b0011,
+      F("First chord should be reported"));
+  _delay_ms(35);
+  helper.doPoll(&chords, &capture);
+  t->verify(capture.callCount == 2 && capture.mask == 0b1100,
+      F("Second chord should get its own window"));
+}
+
+// Takes about 100us to poll, counting how often it was polled
+class SlowSource: public EventSource {
+
+  public:
+    void setup() override {};
+    void poll(void* = nullptr) override {
+      _delay_us(100);
+      pollCount++;
+    };
+    uint8_t pollCount = 0;
+
+};
+
+void testBudgetedPoll(TestInvocation* t) {
+  t->setName(F("Time-budgeted poll resumes round-robin"));
+  SlowSource sources[5];
+  Eventuino evt;
+  for (uint8_t i = 0; i < 5; i++) evt.addEventSource(&sources[i]);
+
+  uint8_t deferred = evt.poll(250, nullptr);
+  t->verify(deferred == 2, F("Expected 3 sources polled, 2 deferred"));
+  t->verify(sources[2].pollCount == 1 && sources[3].pollCount == 0,
+      F("Should stop once the budget is spent"));
+
+  deferred = evt.poll(250, nullptr);
+  t->verify(deferred == 2, F("Expected 2 deferred again"));
+  t->verify(sources[3].pollCount == 1 && sources[4].pollCount == 1,
+      F("Should resume where the last call stopped"));
+  t->verify(sources[0].pollCount == 2 && sources[1].pollCount == 1,
+      F("Should wrap around to the first source"));
+
+  deferred = evt.poll(0, nullptr);
+  t->verify(deferred == 4, F("At least one source is always polled"));
+  t->verify(sources[1].pollCount == 2, F("Source 1 was next in line"));
+
+  deferred = evt.poll(10000, nullptr);
+  t->verify(deferred == 0, F("A large budget should poll every source"));
+  for (uint8_t i = 0; i < 5; i++) {
+    t->verify(sources[i].pollCount == (i <= 1 ? 3 : 2), F("Each source polled once more"));
+  }
+}
+
+void testPollRates(TestInvocation* t) {
+  t->setName(F("Per-source poll divisors and intervals"));
+  SlowSource everyCycle, divided, timed;
+  Eventuino evt;
+  evt.addEventSource(&everyCycle);
+  evt.addEventSource(&divided);
+  t->verify(!evt.setPollIntervalMs(&timed, 10), F("Unknown source should be rejected"));
+  evt.addEventSource(&timed);
+  evt.setPollDivisor(&divided, Eventuino::PRIORITY_NORMAL);
+  evt.setPollIntervalMs(&timed, 10);
+
+  for (uint8_t i = 0; i < 8; i++) {
+    evt.poll();
+    _delay_ms(1);
+  }
+  t->verify(everyCycle.pollCount == 8, F("Default source should be polled every cycle"));
+  t->verify(divided.pollCount == 2, F("Divided source should be polled every 4th cycle"));
+  t->verify(timed.pollCount == 1, F("Timed source should be polled once so far"));
+  _delay_ms(10);
+  evt.poll();
+  t->verify(timed.pollCount == 2, F("Timed source should be due again"));
+
+  evt.setPollDivisor(&divided, Eventuino::PRIORITY_REALTIME);
+  evt.poll();
+  t->verify(divided.pollCount == 3, F("Divisor of 1 should poll every cycle"));
+}
+
+struct TaskCapture {
+  Button* button;
+  uint8_t step = 0;
+  uint8_t runCount = 0;
+};
+
+void testTask(TestInvocation* t) {
+  t->setName(F("Task awaits presses and delays"));
+  Button b = helper.buttonSrc(1, 3);
+  TaskCapture capture;
+  capture.button = &b;
+  Task task([](Task* task, void* state) {
+    TaskCapture* c = static_cast<TaskCapture*>(state);
+    c->runCount++;
+    TASK_BEGIN(task);
+    c->step = 1;
+    TASK_AWAIT_PRESS(task, c->button);
+    c->step = 2;
+    TASK_AWAIT_MS(task, 50);
+    c->step = 3;
+    TASK_AWAIT_RELEASE(task, c->button);
+    c->step = 4;
+    TASK_END(task);
+  });
+
+  helper.doPoll(&task, &capture);
+  helper.doPoll(&task, &capture);
+  t->verify(capture.step == 1, F("Task should be awaiting the press"));
+  t->verify(capture.runCount == 1, F("Task should not resume until pressed"));
+  helper.doBouncyActivate(&b);
+  helper.doPoll(&task, &capture);
+  t->verify(capture.step == 2, F("Task should resume on the press"));
+  t->verify(task.idleMs() > 40, F("Task should be idle during the delay"));
+  _delay_ms(30);
+  helper.doPoll(&task, &capture);
+  t->verify(capture.step == 2 && capture.runCount == 2, F("Delay hasn't passed yet"));
+  _delay_ms(25);
+  helper.doPoll(&task, &capture);
+  t->verify(capture.step == 3, F("Task should resume after the delay"));
+  helper.doBouncyDeactivate(&b);
+  helper.doPoll(&task, &capture);
+  t->verify(capture.step == 4 && task.isFinished(), F("Task should have finished"));
+  helper.doPoll(&task, &capture);
+  t->verify(capture.runCount == 4, F("Finished task should not run"));
+
+  task.restart();
+  helper.doPoll(&task, &capture);
+  t->verify(capture.step == 1 && !task.isFinished(), F("Task should start over"));
+}
+
+struct QueueCapture {
+  uint8_t order[4];
+  uint8_t callCount = 0;
+};
+
+void testEventQueue(TestInvocation* t) {
+  t->setName(F("EventQueue defers and prioritizes events"));
+  Button low = helper.buttonSrc(1, 1);
+  Button high = helper.buttonSrc(2, 2);
+  auto onPressed = [](uint8_t value, void* state) {
+    QueueCapture* c = static_cast<QueueCapture*>(state);
+    c->order[c->callCount++ & 3] = value;
+  };
+  low.onPressed = onPressed;
+  high.onPressed = onPressed;
+  EventQueue queue(2, 1);
+  queue.priorityOf = [](uint8_t value, uint8_t) -> uint8_t {
+    return value == 2 ? 0 : 5;
+  };
+  Eventuino evt;
+  evt.addEventSource(&low);
+  evt.addEventSource(&high);
+  evt.setEventQueue(&queue);
+  QueueCapture capture;
+
+  // Both buttons share the helper's pin, so they're pressed together
+  helper.digitalReadValue = EventuinoHal::LOW_STATE;
+  evt.poll(&capture);
+  _delay_ms(15);
+  evt.poll(&capture);
+  t->verify(capture.callCount == 1, F("Only 1 event should be dispatched per poll"));
+  t->verify(capture.order[0] == 2, F("Higher priority event should be first"));
+  t->verify(queue.size() == 1, F("Lower priority event should still be queued"));
+  t->verify(evt.idleMs() == 0, F("Queued events should keep the loop awake"));
+  evt.poll(&capture);
+  t->verify(capture.callCount == 2 && capture.order[1] == 1, F("Queued event should follow"));
+
+  // As from an interrupt handler
+  t->verify(queue.post(onPressed, 7, EventSource::KIND_CHANGE), F("Post should succeed"));
+  t->verify(queue.post(onPressed, 8, EventSource::KIND_CHANGE), F("Post should succeed"));
+  t->verify(!queue.post(onPressed, 9, EventSource::KIND_CHANGE), F("Queue should be full"));
+  t->verify(queue.overflowCount() == 1, F("Overflow should be counted"));
+  evt.poll(&capture);
+  evt.poll(&capture);
+  t->verify(capture.callCount == 4 && capture.order[2] == 7 && capture.order[3] == 8,
+      F("Posted events should be dispatched in order"));
+
+  // Sources polled by another Eventuino don't post into this one's queue
+  Button other = helper.buttonSrc(3, 3);
+  other.onPressed = onPressed;
+  Eventuino otherEvt;
+  otherEvt.addEventSource(&other);
+  otherEvt.poll(&capture);
+  _delay_ms(15);
+  otherEvt.poll(&capture);
+  t->verify(capture.callCount == 5 && queue.size() == 0,
+      F("Another instance's callbacks should be inline"));
+
+  evt.setEventQueue(nullptr);
+  helper.digitalReadValue = EventuinoHal::HIGH_STATE;
+  evt.poll(&capture);
+  _delay_ms(15);
+  evt.poll(&capture);
+  helper.digitalReadValue = EventuinoHal::LOW_STATE;
+  evt.poll(&capture);
+  _delay_ms(15);
+  evt.poll(&capture);
+  t->verify(capture.callCount == 7, F("Callbacks should be inline again"));
+}
+
+uint8_t transitionEvents = 0;
+
+void testTransitionTable(TestInvocation* t) {
+  t->setName(F("Table-driven transitions match the reference"));
+  Button b = helper.buttonSrc(1, 1);
+  auto onChange = [](uint8_t, void*) { transitionEvents |= 1; };
+  b.onPressed = onChange;
+  b.onReleased = onChange;
+  b.onLongPress = [](uint8_t, void*) { transitionEvents |= 2; };
+
+  // Elapsed times on either side of every debounce, long hold and
+  // repeat boundary, including the 16-bit wraparound
+  static const uint16_t offsets[] = { 0, 1, 10, 11, 50, 51, 60, 61, 0x8000, 0xFFFF };
+  const uint8_t offsetCount = sizeof(offsets) / sizeof(offsets[0]);
+  uint16_t mismatches = 0;
+  for (uint8_t bits = 0; bits < 32; bits++) {
+    for (uint8_t reading = 0; reading < 2; reading++) {
+      for (uint8_t i = 0; i < offsetCount; i++) {
+        for (uint8_t j = 0; j < offsetCount; j++) {
+          uint16_t now;
+          PinSnapshot start;
+          do {
+            // Redo the poll if EventuinoHal::millis() ticked during it
+            now = EventuinoHal::millis();
+            start = { bits, (uint16_t)(now - offsets[i]), (uint16_t)(now - offsets[j]) };
+            helper.setPinState(&b, start);
+            helper.digitalReadValue = reading ? EventuinoHal::HIGH_STATE : EventuinoHal::LOW_STATE;
+            transitionEvents = 0;
+            helper.doPoll(&b);
+          } while ((uint16_t)EventuinoHal::millis() != now);
+          PinSnapshot expected = start;
+          uint8_t expectedEvents = helper.referencePoll(expected,
+              helper.digitalReadValue, now, 10, 50, 10);
+          PinSnapshot actual = helper.getPinState(&b);
+          if (actual.state != expected.state || actual.toggleTime != expected.toggleTime ||
+              actual.lastRepeat != expected.lastRepeat || transitionEvents != expectedEvents) {
+            mismatches++;
+          }
+        }
+      }
+    }
+  }
+  t->verify(mismatches == 0, F("Transitions differ from the reference"));
+}
+
+uint16_t selectorBits = 0;
+
+struct PositionCapture {
+  uint8_t value = 0;
+  uint8_t position = 0;
+  uint8_t callCount = 0;
+};
+
+void testPositionSelector(TestInvocation* t) {
+  t->setName(F("PositionSelector debounces the combined position"));
+  static const uint8_t pins[3] = { 4, 5, 6 };
+  auto readBits = [](const uint8_t*, uint8_t) -> uint16_t { return selectorBits; };
+  auto onPosition = [](uint8_t value, uint8_t position, void* state) {
+    PositionCapture* c = static_cast<PositionCapture*>(state);
+    c->value = value;
+    c->position = position;
+    c->callCount++;
+  };
+  PositionSelector gray(pins, 3, 9, PositionSelector::ENCODING_GRAY, 10,
+      [](uint8_t) {}, readBits);
+  gray.onPosition = onPosition;
+  PositionCapture capture;
+
+  selectorBits = 0b011; // Gray 2
+  helper.doPoll(&gray, &capture);
+  _delay_ms(15);
+  helper.doPoll(&gray, &capture);
+  t->verify(capture.callCount == 1, F("Initial position should be reported"));
+  t->verify(capture.value == 9 && capture.position == 2, F("Expected position 2"));
+
+  // Contacts passing through other codes on the way to 5
+  selectorBits = 0b010; // 3
+  helper.doPoll(&gray, &capture);
+  selectorBits = 0b110; // 4
+  helper.doPoll(&gray, &capture);
+  selectorBits = 0b111; // 5
+  helper.doPoll(&gray, &capture);
+  t->verify(capture.callCount == 1, F("Transitional positions should not be reported"));
+  _delay_ms(15);
+  helper.doPoll(&gray, &capture);
+  helper.doPoll(&gray, &capture);
+  t->verify(capture.callCount == 2, F("Should be reported once"));
+  t->verify(gray.getPosition() == 5, F("Expected position 5"));
+
+  // Break-before-make one-hot contacts: no pin active in between
+  PositionSelector oneHot(pins, 3, 10, PositionSelector::ENCODING_ONE_HOT, 10,
+      [](uint8_t) {}, readBits);
+  oneHot.onPosition = onPosition;
+  selectorBits = 0b001;
+  helper.doPoll(&oneHot, &capture);
+  _delay_ms(15);
+  helper.doPoll(&oneHot, &capture);
+  selectorBits = 0;
+  helper.doPoll(&oneHot, &capture);
+  _delay_ms(15);
+  helper.doPoll(&oneHot, &capture);
+  t->verify(capture.callCount == 3 && oneHot.getPosition() == 0,
+      F("No active pin should keep the last position"));
+
+  t->verify(PositionSelector::decode(0x42, PositionSelector::ENCODING_BCD) == 42,
+      F("Expected BCD 42"));
+  t->verify(PositionSelector::decode(0x4A, PositionSelector::ENCODING_BCD) ==
+      PositionSelector::NO_POSITION, F("BCD digit over 9 is invalid"));
+  t->verify(PositionSelector::decode(0b1000, PositionSelector::ENCODING_GRAY) == 15,
+      F("Expected Gray 15"));
+  t->verify(PositionSelector::decode(0b101, PositionSelector::ENCODING_ONE_HOT) ==
+      PositionSelector::NO_POSITION, F("Two one-hot pins is invalid"));
+  t->verify(PositionSelector::decode(0xFF, PositionSelector::ENCODING_BINARY) == 255,
+      F("All 8 binary pins is position 255"));
+  t->verify(PositionSelector::decode(0x80, PositionSelector::ENCODING_GRAY) == 255,
+      F("Gray 0x80 is position 255"));
+}
+
+uint16_t muxInputs[4] = { 0 };
+uint8_t muxSelected = 0;
+uint8_t muxReads = 0;
+
+struct ChannelCapture {
+  uint8_t value = 0;
+  uint8_t channel = 0;
+  uint16_t reading = 0;
+  uint8_t callCount = 0;
+};
+
+void testMuxScanner(TestInvocation* t) {
+  t->setName(F("MuxScanner filters and thresholds each channel"));
+  auto select = [](uint8_t channel) { muxSelected = channel; };
+  auto read = [](uint8_t) -> uint16_t { muxReads++; return muxInputs[muxSelected]; };
+  auto onChange = [](uint8_t value, uint8_t channel, uint16_t reading, void* state) {
+    ChannelCapture* c = static_cast<ChannelCapture*>(state);
+    c->value = value;
+    c->channel = channel;
+    c->reading = reading;
+    c->callCount++;
+  };
+  MuxScanner mux(0, 4, 11, select, read);
+  mux.onChannelChange = onChange;
+  mux.setSettleMicros(0);
+  mux.setFilter(0);
+  ChannelCapture capture;
+
+  muxInputs[0] = 100; muxInputs[1] = 200; muxInputs[2] = 300; muxInputs[3] = 400;
+  helper.doPoll(&mux, &capture);
+  t->verify(muxReads == 4, F("One poll should scan every channel once"));
+  t->verify(capture.callCount == 4, F("First readings should be reported"));
+  t->verify(capture.value == 11 && capture.channel == 3 && capture.reading == 400,
+      F("Expected channel 3 at 400"));
+  t->verify(mux.getReading(1) == 200, F("Expected channel 1 at 200"));
+
+  // Changes under the threshold are noise
+  muxInputs[2] = 302;
+  helper.doPoll(&mux, &capture);
+  t->verify(capture.callCount == 4, F("Change under the threshold should not be reported"));
+  muxInputs[2] = 310;
+  helper.doPoll(&mux, &capture);
+  t->verify(capture.callCount == 5 && capture.channel == 2 && capture.reading == 310,
+      F("Expected channel 2 at 310"));
+
+  // Filtered readings approach a step change
+  mux.setFilter(2);
+  muxInputs[0] = 200;
+  helper.doPoll(&mux, &capture);
+  t->verify(mux.getReading(0) == 125, F("Expected a quarter of the step"));
+  for (uint8_t i = 0; i < 20; i++) helper.doPoll(&mux, &capture);
+  t->verify(mux.getReading(0) > 196 && mux.getReading(0) <= 200,
+      F("Filtered reading should settle near the input"));
+
+  // Readings from a 16-bit ADC don't wrap in the filter
+  muxInputs[3] = 60000;
+  for (uint8_t i = 0; i < 30; i++) helper.doPoll(&mux, &capture);
+  t->verify(mux.getReading(3) > 59000 && mux.getReading(3) <= 60000,
+      F("16-bit reading should settle near the input"));
+
+  // Without a time slice, poll() doesn't wait for the mux to settle
+  mux.setSettleMicros(50);
+  _delay_us(60);
+  muxReads = 0;
+  helper.doPoll(&mux, &capture);
+  t->verify(muxReads == 1, F("Should read the settled channel only"));
+  helper.doPoll(&mux, &capture);
+  t->verify(muxReads == 1, F("Next channel should still be settling"));
+  _delay_us(60);
+  helper.doPoll(&mux, &capture);
+  t->verify(muxReads == 2, F("Settled channel should be read"));
+}
+
+const uint8_t blinkSteps[] PROGMEM = { BLINK_ON(30), BLINK_OFF(20), BLINK_END };
+
+void testOutputs(TestInvocation* t) {
+  t->setName(F("Outputs are driven from poll()"));
+  BlinkPattern blink(8, 12);
+  blink.onFinished = [](uint8_t value, void* state) {
+    *static_cast<uint8_t*>(state) = value;
+  };
+  uint8_t finished = 0;
+  blink.setup();
+  blink.playFlash(blinkSteps, 2);
+  t->verify(EventuinoHal::digitalReadPin(8) == EventuinoHal::HIGH_STATE, F("Pattern should start on"));
+  _delay_ms(35);
+  helper.doPoll(&blink, &finished);
+  t->verify(EventuinoHal::digitalReadPin(8) == EventuinoHal::LOW_STATE, F("Expected the off step"));
+  t->verify(blink.idleMs() > 0 && blink.idleMs() <= 20, F("Should idle until the next step"));
+  _delay_ms(20);
+  helper.doPoll(&blink, &finished);
+  t->verify(EventuinoHal::digitalReadPin(8) == EventuinoHal::HIGH_STATE, F("Expected the second play"));
+  _delay_ms(30);
+  helper.doPoll(&blink, &finished);
+  _delay_ms(20);
+  helper.doPoll(&blink, &finished);
+  t->verify(!blink.isPlaying() && EventuinoHal::digitalReadPin(8) == EventuinoHal::LOW_STATE, F("Should end off"));
+  t->verify(finished == 12, F("onFinished should be called"));
+
+  PulseOutput pulse(9, true);
+  pulse.setup();
+  t->verify(EventuinoHal::digitalReadPin(9) == EventuinoHal::HIGH_STATE, F("Active-low pulse should idle high"));
+  pulse.pulse(20);
+  _delay_ms(10);
+  helper.doPoll(&pulse);
+  t->verify(pulse.isActive() && EventuinoHal::digitalReadPin(9) == EventuinoHal::LOW_STATE, F("Pulse should be active"));
+  _delay_ms(15);
+  helper.doPoll(&pulse);
+  t->verify(!pulse.isActive() && EventuinoHal::digitalReadPin(9) == EventuinoHal::HIGH_STATE, F("Pulse should have ended"));
+
+  static const uint8_t pwmPins[2] = { 8, 9 };
+  SoftPwm pwm(pwmPins, 2, 1000);
+  pwm.setup();
+  pwm.setDuty(0, 128);
+  pwm.setDuty(1, 255);
+  helper.doPoll(&pwm);
+  t->verify(EventuinoHal::digitalReadPin(8) == EventuinoHal::HIGH_STATE && EventuinoHal::digitalReadPin(9) == EventuinoHal::HIGH_STATE,
+      F("Both pins should start the cycle on"));
+  t->verify(pwm.idleMs() == 0, F("Should not idle while switching"));
+  _delay_us(600);
+  helper.doPoll(&pwm);
+  t->verify(EventuinoHal::digitalReadPin(8) == EventuinoHal::LOW_STATE && EventuinoHal::digitalReadPin(9) == EventuinoHal::HIGH_STATE,
+      F("Half duty pin should be off late in the cycle"));
+  _delay_us(500);
+  helper.doPoll(&pwm);
+  t->verify(EventuinoHal::digitalReadPin(8) == EventuinoHal::HIGH_STATE, F("Expected the next cycle"));
+  pwm.setDuty(0, 0);
+  helper.doPoll(&pwm);
+  t->verify(EventuinoHal::digitalReadPin(8) == EventuinoHal::LOW_STATE, F("Zero duty should be off"));
+  t->verify(pwm.idleMs() == 0xFFFF, F("Steady outputs should idle"));
+}
+
+struct DelegateCounter {
+  uint8_t value = 0;
+  uint8_t callCount = 0;
+  void onEvent(uint8_t v, void*) {
+    value = v;
+    callCount++;
+  }
+};
+
+void countByTen(DelegateCounter* c, uint8_t value, void*) {
+  c->value = value;
+  c->callCount += 10;
+}
+
+void testEventDelegate(TestInvocation* t) {
+  t->setName(F("Callbacks bound to their own context"));
+  DelegateCounter pressed;
+  DelegateCounter released;
+  DelegateCounter expired;
+  Button btn = helper.buttonSrc(1, 5);
+  btn.onPressed = EventDelegate::bind<DelegateCounter, &DelegateCounter::onEvent>(&pressed);
+  btn.onReleased = EventDelegate::bind(&released, [](DelegateCounter* c, uint8_t value, void*) {
+    c->value = value;
+    c->callCount++;
+  });
+  helper.doBouncyActivate(&btn);
+  t->verify(pressed.callCount == 1 && pressed.value == 5, F("Member function not called"));
+  t->verify(released.callCount == 0, F("onReleased called too soon"));
+  helper.doBouncyDeactivate(&btn);
+  t->verify(released.callCount == 1 && released.value == 5, F("Lambda not called"));
+  t->verify(pressed.callCount == 1, F("onPressed called again"));
+
+  Timer14Bit tmr = helper.timerSrc(7);
+  tmr.onExpire = EventDelegate::bind<DelegateCounter, countByTen>(&expired);
+  tmr.start(10);
+  _delay_ms(12);
+  helper.doPoll(&tmr);
+  t->verify(expired.callCount == 10 && expired.value == 7, F("Function not called"));
+
+  // Bound callbacks can be queued like plain ones
+  EventQueue queue(2);
+  queue.post(btn.onPressed, 9, EventSource::KIND_ACTIVATE);
+  queue.dispatch();
+  t->verify(pressed.callCount == 2 && pressed.value == 9, F("Queued member function not called"));
+
+  btn.clearCallbacks();
+  t->verify(!btn.onPressed && !btn.onReleased, F("Callbacks should be cleared"));
+}
+
+void testWarmRestart(TestInvocation* t) {
+  t->setName(F("Warm restart from a snapshot"));
+  CallbackCapture capture;
+  auto onEvent = [](uint8_t value, void* state = nullptr) {
+    CallbackCapture* c = static_cast<CallbackCapture*>(state);
+    c->value = value;
+    c->callCount++;
+  };
+  uint8_t snapshot[32];
+  uint16_t size = 0;
+  {
+    Eventuino evt;
+    Toggle tog = helper.toggleSrc(1, 2);
+    IntervalTimer14Bit tmr = helper.intervalTimerSrc(9);
+    evt.addEventSource(&tog);
+    evt.addEventSource(&tmr);
+    evt.begin();
+    tog.onActivate = onEvent;
+    tmr.onExpire = onEvent;
+    helper.doBouncyActivate(&tog, &capture);
+    tmr.start(30);
+    t->verify(evt.saveState(snapshot, evt.snapshotSize() - 1) == 0,
+        F("Should not save into a short buffer"));
+    size = evt.saveState(snapshot, sizeof(snapshot));
+    t->verify(size > 0 && size <= evt.snapshotSize(), F("Snapshot not saved"));
+  }
+
+  // As if after a reset, with the toggle still on
+  capture.callCount = 0;
+  Eventuino evt;
+  Toggle tog = helper.toggleSrc(1, 2);
+  IntervalTimer14Bit tmr = helper.intervalTimerSrc(9);
+  evt.addEventSource(&tog);
+  t->verify(!evt.restoreState(snapshot, size), F("Restored with a source missing"));
+  evt.addEventSource(&tmr);
+  evt.begin();
+  tog.onActivate = onEvent;
+  tmr.onExpire = onEvent;
+  snapshot[4] ^= 0x01;
+  t->verify(!evt.restoreState(snapshot, size), F("Restored a corrupt snapshot"));
+  snapshot[4] ^= 0x01;
+  t->verify(!evt.restoreState(snapshot, size - 1), F("Restored a truncated snapshot"));
+  {
+    // As if a firmware update added the same sources in another order
+    Eventuino reordered;
+    reordered.addEventSource(&tmr);
+    reordered.addEventSource(&tog);
+    t->verify(!reordered.restoreState(snapshot, size), F("Restored into reordered sources"));
+  }
+  t->verify(evt.restoreState(snapshot, size), F("Snapshot not restored"));
+  t->verify(tog.isActivated(), F("Toggle should resume active"));
+
+  helper.digitalReadValue = EventuinoHal::LOW_STATE;
+  evt.poll(&capture);
+  _delay_ms(15);
+  evt.poll(&capture);
+  t->verify(capture.callCount == 0, F("Spurious activate after restore"));
+  _delay_ms(20);
+  evt.poll(&capture);
+  t->verify(capture.callCount == 1 && capture.value == 9, F("Timer did not resume"));
+  _delay_ms(32);
+  evt.poll(&capture);
+  t->verify(capture.callCount == 2, F("Interval not restored"));
+}
+
+struct RestartCapture {
+  uint8_t groupCalls = 0;
+  uint8_t positionCalls = 0;
+};
+
+void testWarmRestartGroup(TestInvocation* t) {
+  t->setName(F("Warm restart of a group and a selector"));
+  static const uint8_t pins[3] = { 4, 5, 6 };
+  auto readBits = [](const uint8_t*, uint8_t) -> uint16_t { return selectorBits; };
+  auto onGroupChange = [](uint8_t, uint8_t, void* state = nullptr) {
+    static_cast<RestartCapture*>(state)->groupCalls++;
+  };
+  auto onPosition = [](uint8_t, uint8_t, void* state) {
+    static_cast<RestartCapture*>(state)->positionCalls++;
+  };
+  uint8_t snapshot[32];
+  uint16_t size = 0;
+  helper.digitalReadValue = EventuinoHal::LOW_STATE;
+  selectorBits = 0b101;
+  {
+    Eventuino evt;
+    DigitalPinSource a = helper.digitalPinSrc(1, 1);
+    DigitalPinSource b = helper.digitalPinSrc(2, 2);
+    DigitalPinGroup8 group;
+    group.addSource(&a);
+    group.addSource(&b);
+    PositionSelector selector(pins, 3, 9, PositionSelector::ENCODING_BINARY, 10,
+        [](uint8_t) {}, readBits);
+    evt.addEventSource(&group);
+    evt.addEventSource(&selector);
+    evt.begin();
+    RestartCapture capture;
+    evt.poll(&capture);
+    _delay_ms(15);
+    evt.poll(&capture);
+    t->verify(group.stateMask() == 0b11 && selector.getPosition() == 5,
+        F("Should be active before the reset"));
+    size = evt.saveState(snapshot, sizeof(snapshot));
+    t->verify(size > 0 && size <= evt.snapshotSize(), F("Snapshot not saved"));
+  }
+
+  // As if after a reset, with the pins and the selector unchanged
+  Eventuino evt;
+  DigitalPinSource a = helper.digitalPinSrc(1, 1);
+  DigitalPinSource b = helper.digitalPinSrc(2, 2);
+  DigitalPinGroup8 group;
+  group.addSource(&a);
+  group.addSource(&b);
+  PositionSelector selector(pins, 3, 9, PositionSelector::ENCODING_BINARY, 10,
+      [](uint8_t) {}, readBits);
+  group.onGroupChange = onGroupChange;
+  selector.onPosition = onPosition;
+  evt.addEventSource(&group);
+  evt.addEventSource(&selector);
+  evt.begin();
+  t->verify(evt.restoreState(snapshot, size), F("Snapshot not restored"));
+  t->verify(group.stateMask() == 0b11,
+      F("Group should resume active"));
+  t->verify(selector.getPosition() == 5, F("Selector should resume its position"));
+  RestartCapture capture;
+  evt.poll(&capture);
+  _delay_ms(15);
+  evt.poll(&capture);
+  t->verify(capture.groupCalls == 0, F("Spurious group change after restore"));
+  t->verify(capture.positionCalls == 0, F("Spurious position after restore"));
+  helper.digitalReadValue = EventuinoHal::HIGH_STATE;
+}
+
+void testSeededBegin(TestInvocation* t) {
+  t->setName(F("Seeded begin() takes the initial state"));
+  CallbackCapture capture;
+  auto onEvent = [](uint8_t value, void* state = nullptr) {
+    CallbackCapture* c = static_cast<CallbackCapture*>(state);
+    c->value = value;
+    c->callCount++;
+  };
+  Button pinned(7, 1);
+  t->verify(pinned.inputPullupPin() == 7, F("Default pin setup should be batched"));
+
+  Eventuino evt;
+  Toggle tog = helper.toggleSrc(1, 2);
+  Button btn = helper.buttonSrc(1, 3);
+  t->verify(tog.inputPullupPin() == EventSource::NO_PIN, F("Custom pin setup can't be batched"));
+  tog.onActivate = onEvent;
+  btn.onPressed = onEvent;
+  evt.addEventSource(&tog);
+  evt.addEventSource(&btn);
+  helper.digitalReadValue = EventuinoHal::LOW_STATE;
+  evt.begin(Eventuino::BEGIN_SEEDED);
+  t->verify(helper.didPinSetup, F("Custom pin setup should have been called"));
+  t->verify(tog.isActivated() && btn.isPressed(), F("Should start active"));
+  evt.poll(&capture);
+  _delay_ms(15);
+  evt.poll(&capture);
+  t->verify(capture.callCount == 0, F("Seeding should not invoke callbacks"));
+
+  Eventuino notifying;
+  Toggle seeded = helper.toggleSrc(1, 4);
+  seeded.onActivate = onEvent;
+  notifying.addEventSource(&seeded);
+  notifying.begin(Eventuino::BEGIN_SEEDED_NOTIFY, 0, &capture);
+  t->verify(capture.callCount == 1 && capture.value == 4, F("Initial state not reported"));
+  helper.digitalReadValue = EventuinoHal::HIGH_STATE;
+  notifying.poll(&capture);
+  _delay_ms(15);
+  notifying.poll(&capture);
+  t->verify(!seeded.isActivated(), F("Should deactivate as usual"));
+}
+
+struct SerialFeed {
+  const uint8_t* bytes = nullptr;
+  uint8_t length = 0;
+  uint8_t position = 0;
+};
+SerialFeed serialFeed;
+
+void feedSerial(const void* bytes, uint8_t length) {
+  serialFeed.bytes = static_cast<const uint8_t*>(bytes);
+  serialFeed.length = length;
+  serialFeed.position = 0;
+}
+
+int16_t readSerialFeed() {
+  if (serialFeed.position >= serialFeed.length) return -1;
+  return serialFeed.bytes[serialFeed.position++];
+}
+
+struct FrameCapture {
+  uint8_t callCount = 0;
+  uint8_t length = 0;
+  uint8_t frame[16];
+};
+
+void testSerialLineSource(TestInvocation* t) {
+  t->setName(F("Serial lines and frames assembled without blocking"));
+  FrameCapture capture;
+  auto onFrame = [](uint8_t, const uint8_t* frame, uint8_t length, void* state) {
+    FrameCapture* c = static_cast<FrameCapture*>(state);
+    memcpy(c->frame, frame, length < 15 ? length + 1 : 16);
+    c->length = length;
+    c->callCount++;
+  };
+
+  SerialLineSource lines(8, 1, SerialLineSource::FRAMING_LINE, readSerialFeed);
+  lines.onFrame = onFrame;
+  feedSerial("set 1\r\nsp", 9);
+  helper.doPoll(&lines, &capture);
+  t->verify(capture.callCount == 1 && capture.length == 5, F("Line not dispatched"));
+  t->verify(strcmp((const char*)capture.frame, "set 1") == 0, F("Line should be NUL-terminated"));
+  feedSerial("eed 20\n\n\nok\n", 12);
+  helper.doPoll(&lines, &capture);
+  t->verify(lines.getOverflowCount() == 1, F("Long line should be dropped"));
+  t->verify(capture.callCount == 2, F("Empty lines should be skipped"));
+  t->verify(strcmp((const char*)capture.frame, "ok") == 0, F("Expected ok"));
+
+  lines.setMaxBytesPerPoll(2);
+  feedSerial("ab\n", 3);
+  helper.doPoll(&lines, &capture);
+  t->verify(capture.callCount == 2, F("Should stop after 2 bytes"));
+  helper.doPoll(&lines, &capture);
+  t->verify(capture.callCount == 3, F("Rest of the line not taken"));
+
+  SerialLineSource frames(4, 2, SerialLineSource::FRAMING_LENGTH_PREFIXED, readSerialFeed);
+  frames.onFrame = onFrame;
+  capture.callCount = 0;
+  const uint8_t framed[] = { 3, 'x', 0, 'z', 5, 1, 2, 3, 4, 5, 0, 2, 'o', 'k' };
+  feedSerial(framed, sizeof(framed));
+  helper.doPoll(&frames, &capture);
+  t->verify(capture.callCount == 2 && frames.getOverflowCount() == 1,
+      F("Oversized frame should be dropped"));
+  t->verify(capture.length == 2 && capture.frame[0] == 'o', F("Expected ok frame"));
+
+  frames.setFrameTimeoutMs(10);
+  const uint8_t partial[] = { 3, 'a' };
+  feedSerial(partial, sizeof(partial));
+  helper.doPoll(&frames, &capture);
+  _delay_ms(15);
+  const uint8_t next[] = { 2, 'h', 'i' };
+  feedSerial(next, sizeof(next));
+  helper.doPoll(&frames, &capture);
+  t->verify(capture.callCount == 3 && capture.frame[0] == 'h',
+      F("Stalled frame should be dropped"));
+}
+
+struct BlockCapture {
+  uint8_t channelCount = 2;
+  uint8_t callCount = 0;
+  uint16_t frameCount = 0;
+  uint16_t samples[8];
+};
+
+uint16_t sampleCounter = 0;
+uint16_t readSampleCounter(uint8_t pin) {
+  return pin * 100 + sampleCounter++;
+}
+
+void testBlockSampler(TestInvocation* t) {
+  t->setName(F("BlockSampler fills and hands over blocks"));
+  BlockCapture capture;
+  auto onBlock = [](uint8_t, const uint16_t* samples, uint16_t frameCount, void* state) {
+    BlockCapture* c = static_cast<BlockCapture*>(state);
+    memcpy(c->samples, samples, frameCount * c->channelCount * sizeof(uint16_t));
+    c->frameCount = frameCount;
+    c->callCount++;
+  };
+
+  // Two channels, 4 frames per block, a tick every 2ms
+  const uint8_t pins[] = { 1, 2 };
+  sampleCounter = 0;
+  BlockSampler polled(pins, 2, 4, 2000, 1, readSampleCounter);
+  polled.onBlock = onBlock;
+  polled.start();
+  for (uint8_t i = 0; i < 3; i++) {
+    helper.doPoll(&polled, &capture);
+    t->verify(capture.callCount == 0, F("Block handed over too soon"));
+    _delay_ms(2);
+  }
+  helper.doPoll(&polled, &capture);
+  t->verify(capture.callCount == 1 && capture.frameCount == 4, F("Block not handed over"));
+  t->verify(capture.samples[0] == 100 && capture.samples[1] == 201 &&
+      capture.samples[6] == 106 && capture.samples[7] == 207,
+      F("Samples should be interleaved by channel"));
+  t->verify(polled.getOverrunCount() == 0, F("No ticks should be skipped"));
+  _delay_ms(7);
+  helper.doPoll(&polled, &capture);
+  t->verify(polled.getOverrunCount() == 2, F("Late ticks should be skipped"));
+
+  // Pushed from an interrupt, with no poll() to release the buffers
+  BlockSampler pushed(1, 2, 2);
+  pushed.onBlock = onBlock;
+  capture.channelCount = 1;
+  capture.callCount = 0;
+  t->verify(!pushed.pushFromIsr(1), F("Should not take samples until started"));
+  pushed.start();
+  for (uint16_t s = 1; s <= 6; s++) pushed.pushFromIsr(s);
+  t->verify(pushed.getOverrunCount() == 2, F("Third block should be dropped"));
+  helper.doPoll(&pushed, &capture);
+  t->verify(capture.callCount == 2 && capture.samples[0] == 3, F("Both blocks, oldest first"));
+  t->verify(pushed.pushFromIsr(7), F("Buffers should be free again"));
+}
+
+struct PulseCapture {
+  uint8_t callCount = 0;
+  uint32_t count = 0;
+  uint32_t span = 0;
+  uint32_t width = 0;
+  uint32_t period = 0;
+};
+
+void testPulseSources(TestInvocation* t) {
+  t->setName(F("PulseCounter and PulseTimer report at an interval"));
+  PulseCapture capture;
+  PulseCounter counter(10, 1);
+  counter.onCount = [](uint8_t, uint32_t count, uint32_t spanMicros, void* state) {
+    PulseCapture* c = static_cast<PulseCapture*>(state);
+    c->count = count;
+    c->span = spanMicros;
+    c->callCount++;
+  };
+  counter.setup();
+  for (uint32_t i = 1; i <= 5; i++) counter.edgeFromIsr(i * 1000);
+  helper.doPoll(&counter, &capture);
+  t->verify(capture.callCount == 0, F("Reported before the interval"));
+  _delay_ms(12);
+  helper.doPoll(&counter, &capture);
+  t->verify(capture.callCount == 1 && capture.count == 5 && capture.span == 0,
+      F("First report should have no span"));
+  for (uint32_t i = 6; i <= 9; i++) counter.edgeFromIsr(i * 1000);
+  _delay_ms(12);
+  helper.doPoll(&counter, &capture);
+  t->verify(capture.callCount == 2 && capture.count == 4 && capture.span == 4000,
+      F("Span should run edge to edge"));
+  t->verify(PulseCounter::frequencyMilliHz(capture.count, capture.span) == 1000000,
+      F("Frequency should be 1kHz"));
+  t->verify(PulseCounter::frequencyMilliHz(1000, 500000000) == 2000 &&
+      PulseCounter::frequencyMilliHz(3000, 4000000000) == 750,
+      F("Frequency over a long idle span"));
+  t->verify(counter.getTotalCount() == 9, F("Total count"));
+  _delay_ms(12);
+  helper.doPoll(&counter, &capture);
+  t->verify(capture.callCount == 2, F("No edges should mean no report"));
+
+  PulseTimer pwm(10, 2);
+  pwm.onPulse = [](uint8_t, uint32_t widthMicros, uint32_t periodMicros, void* state) {
+    PulseCapture* c = static_cast<PulseCapture*>(state);
+    c->width = widthMicros;
+    c->period = periodMicros;
+    c->callCount++;
+  };
+  capture.callCount = 0;
+  pwm.setup();
+  pwm.edgeFromIsr(EventuinoHal::LOW_STATE, 500);  // mid-pulse, ignored
+  pwm.edgeFromIsr(EventuinoHal::HIGH_STATE, 1000);
+  pwm.edgeFromIsr(EventuinoHal::LOW_STATE, 2500);
+  pwm.edgeFromIsr(EventuinoHal::HIGH_STATE, 6000);
+  pwm.edgeFromIsr(EventuinoHal::LOW_STATE, 7800);
+  _delay_ms(12);
+  helper.doPoll(&pwm, &capture);
+  t->verify(capture.callCount == 1 && capture.width == 1800 && capture.period == 5000,
+      F("Should report the latest pulse"));
+  _delay_ms(12);
+  helper.doPoll(&pwm, &capture);
+  t->verify(capture.callCount == 2 && capture.width == 0 && capture.period == 0,
+      F("Should report the pulses stopping"));
+  _delay_ms(12);
+  helper.doPoll(&pwm, &capture);
+  t->verify(capture.callCount == 2, F("Should report stopping once"));
+  pwm.edgeFromIsr(EventuinoHal::HIGH_STATE, 90000);
+  pwm.edgeFromIsr(EventuinoHal::LOW_STATE, 91000);
+  _delay_ms(12);
+  helper.doPoll(&pwm, &capture);
+  t->verify(capture.callCount == 3 && capture.width == 1000 && capture.period == 0,
+      F("A restart should have no period"));
+
+  // Reporting more often than the pulses come sees none every other time
+  PulseTimer rc(10, 3);
+  rc.onPulse = pwm.onPulse;
+  capture.callCount = 0;
+  rc.setup();
+  for (uint32_t i = 0; i < 3; i++) {
+    rc.edgeFromIsr(EventuinoHal::HIGH_STATE, i * 20000 + 5000);
+    rc.edgeFromIsr(EventuinoHal::LOW_STATE, i * 20000 + 7000);
+    _delay_ms(11);
+    helper.doPoll(&rc, &capture);
+    _delay_ms(10);
+    helper.doPoll(&rc, &capture);
+  }
+  t->verify(capture.callCount == 3 && capture.width == 2000 && capture.period == 20000,
+      F("A report between pulses isn't them stopping"));
+  _delay_ms(35);
+  helper.doPoll(&rc, &capture);
+  t->verify(capture.callCount == 4 && capture.width == 0 && capture.period == 0,
+      F("Should report stopping a period after the last edge"));
+}
+
 int main() {
   BareMetalHAL::Uart0::begin(9600);
   BareMetalHAL::timingInit();
@@ -205,7 +1353,27 @@ int main() {
     testButtonLongPress,
     testToggle,
     testTimer,
-    testIntervalTimer
+    testIntervalTimer,
+    testRoutingTable,
+    testBasicButtonTiming,
+    testDebounceModes,
+    testDigitalPinGroup,
+    testGestureRecognizer,
+    testBudgetedPoll,
+    testPollRates,
+    testTask,
+    testEventQueue,
+    testTransitionTable,
+    testPositionSelector,
+    testMuxScanner,
+    testOutputs,
+    testEventDelegate,
+    testWarmRestart,
+    testWarmRestartGroup,
+    testSeededBegin,
+    testSerialLineSource,
+    testBlockSampler,
+    testPulseSources
   };
 
   runTestSuiteShowMem(tests, before, nullptr);
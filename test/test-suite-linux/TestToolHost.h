@@ -0,0 +1,50 @@
+// Host stand-in for the parts of the TestTool library's API the
+// Eventuino test suites use (TestInvocation, TestFunction and
+// runTestSuite), so the Linux suite reads like the Arduino and
+// bare-metal AVR ones without needing TestTool itself. Results go to
+// stdout, and the process exits non-zero if any test failed.
+
+#ifndef __test_TestToolHost_h
+#define __test_TestToolHost_h
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define F(s) (s)
+
+class TestInvocation {
+
+  public:
+    void setName(const char* name) { _name = name; }
+    void verify(bool condition, const char* message) {
+      if (condition) return;
+      _failures++;
+      printf("  FAILED: %s\n", message);
+    }
+    const char* name() { return _name; }
+    int failures() { return _failures; }
+
+  private:
+    const char* _name = "";
+    int _failures = 0;
+
+};
+
+typedef void (*TestFunction)(TestInvocation* t);
+
+template<size_t N>
+void runTestSuite(TestFunction (&tests)[N], void (*before)(), void (*after)()) {
+  int failed = 0;
+  for (size_t i = 0; i < N; i++) {
+    TestInvocation t;
+    if (before) before();
+    tests[i](&t);
+    if (after) after();
+    printf("%s: %s\n", t.failures() ? "FAIL" : "PASS", t.name());
+    if (t.failures()) failed++;
+  }
+  printf("%d of %d tests failed\n", failed, (int)N);
+  exit(failed ? 1 : 0);
+}
+
+#endif
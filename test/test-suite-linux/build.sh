@@ -0,0 +1,71 @@
+#!/bin/bash
+
+# Usage:
+#   ./build.sh        Build the host-native Linux test suite
+#   ./build.sh -r     Build it, then run it
+#
+# Builds Eventuino with -DNO_ARDUINO -DHAL_LINUX, the Linux GPIO
+# character-device HAL. No GPIO hardware is needed - the tests drive
+# the HAL's edge events through pipes instead.
+#
+# Source discovery and linking mirror ../test-suite-avr/build.sh: every
+# source file under src/ is compiled and archived into a static library,
+# and the linker pulls in only the objects the suite references.
+
+set -euo pipefail
+
+RUN=false
+while getopts "r" opt; do
+  case $opt in
+    r) RUN=true ;;
+  esac
+done
+
+CXX="${CXX:-g++}"
+AR="${AR:-ar}"
+DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+BUILD_DIR="$DIR/build"
+OBJ_DIR="$BUILD_DIR/obj"
+
+CFLAGS=(-std=gnu++11 -Wall -Wextra -O2 -pthread -DNO_ARDUINO -DHAL_LINUX -I "$DIR/../../src")
+
+mkdir -p "$OBJ_DIR"
+
+# build_archive <name> <src-root>
+#
+# Compiles every *.cpp found (recursively) under <src-root> and archives
+# the resulting objects into $BUILD_DIR/lib<name>.a. Prints the archive
+# path.
+build_archive() {
+  local name="$1"
+  local src_root="$2"
+  local objdir="$OBJ_DIR/$name"
+  mkdir -p "$objdir"
+
+  local objs=()
+  local src rel obj
+  while IFS= read -r -d '' src; do
+    rel="${src#"$src_root"/}"
+    obj="$objdir/${rel//\//_}.o"
+    "$CXX" "${CFLAGS[@]}" -c "$src" -o "$obj"
+    objs+=("$obj")
+  done < <(find "$src_root" -name '*.cpp' -print0 | sort -z)
+
+  local archive="$BUILD_DIR/lib${name}.a"
+  rm -f "$archive"
+  "$AR" rcs "$archive" "${objs[@]}"
+  echo "$archive"
+}
+
+build_archive eventuino "$DIR/../../src" >/dev/null
+
+"$CXX" "${CFLAGS[@]}" \
+  "$DIR/test-suite-linux.cpp" \
+  -o "$BUILD_DIR/test-suite-linux" \
+  -L "$BUILD_DIR" -leventuino
+
+echo "Built $BUILD_DIR/test-suite-linux"
+
+if $RUN; then
+  "$BUILD_DIR/test-suite-linux"
+fi
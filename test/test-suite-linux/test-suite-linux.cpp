@@ -0,0 +1,460 @@
+// Host-native Linux test suite for the -DHAL_LINUX build. Pin edges are
+// driven through pipes standing in for GPIO line fds, so no GPIO
+// hardware is needed. Build and run with ./build.sh -r
+
+#include <linux/gpio.h>
+#include <string.h>
+#include <unistd.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include <Eventuino.h>
+#include <ThreadedEventuino.h>
+#include <eventuino/BitSlicedDebouncer.h>
+#include <eventuino/Button.h>
+#include <eventuino/PulseCounter.h>
+#include <eventuino/SerialLineSource.h>
+#include <eventuino/Timer.h>
+#include "TestToolHost.h"
+#include "../../src/hal/EventuinoHal.h"
+
+using namespace eventuino;
+
+#define EDGE_PIN 10
+
+int edgePipe[2] = { -1, -1 };
+
+void before() {
+  DigitalPinSource::setDebounceDelayMs(10);
+  DigitalPinSource::setLongHoldDelayMs(50);
+  DigitalPinSource::setRepeatMs(10);
+  if (pipe(edgePipe) == 0) {
+    EventuinoHal::attachEdgeSource(EDGE_PIN, edgePipe[0], EventuinoHal::HIGH_STATE);
+  }
+}
+
+void after() {
+  EventuinoHal::detachEdgeSource(EDGE_PIN);
+  close(edgePipe[0]);
+  close(edgePipe[1]);
+}
+
+// Writes a synthetic kernel edge event into the pipe
+void writeEdge(bool rising, uint64_t timestampNs) {
+  struct gpio_v2_line_event event;
+  memset(&event, 0, sizeof(event));
+  event.timestamp_ns = timestampNs;
+  event.id = rising ? GPIO_V2_LINE_EVENT_RISING_EDGE : GPIO_V2_LINE_EVENT_FALLING_EDGE;
+  event.offset = EDGE_PIN;
+  if (write(edgePipe[1], &event, sizeof(event)) != sizeof(event)) {
+    perror("write edge");
+  }
+}
+
+struct CallbackCapture {
+  uint8_t value = 0;
+  uint8_t callCount = 0;
+};
+
+void testEdgeEvents(TestInvocation* t) {
+  t->setName(F("Edge events drive pin reads"));
+  t->verify(EventuinoHal::digitalReadPin(EDGE_PIN) == EventuinoHal::HIGH_STATE,
+      F("Pin should start HIGH"));
+  writeEdge(false, 1234);
+  t->verify(EventuinoHal::digitalReadPin(EDGE_PIN) == EventuinoHal::LOW_STATE,
+      F("Falling edge should read LOW"));
+  t->verify(EventuinoHal::lastEdgeNs(EDGE_PIN) == 1234, F("Edge timestamp not kept"));
+  writeEdge(true, 2345);
+  writeEdge(false, 3456);
+  t->verify(EventuinoHal::digitalReadPin(EDGE_PIN) == EventuinoHal::LOW_STATE,
+      F("Last of several edges should win"));
+}
+
+void testWaitForEdge(TestInvocation* t) {
+  t->setName(F("waitForEvents blocks until an edge or deadline"));
+  Button btn(EDGE_PIN, 4);
+  CallbackCapture capture;
+  btn.onPressed = [](uint8_t value, void* state) {
+    CallbackCapture* c = static_cast<CallbackCapture*>(state);
+    c->value = value;
+    c->callCount++;
+  };
+  Eventuino evt;
+  evt.addEventSource(&btn);
+  evt.begin();
+  evt.poll(&capture);
+  t->verify(evt.idleMs() == 0xFFFF, F("A released button should only wait for edges"));
+
+  writeEdge(false, 1);
+  unsigned long start = EventuinoHal::millis();
+  evt.waitForEvents();
+  t->verify(EventuinoHal::millis() - start < 5, F("Should have woken for the pending edge"));
+  evt.poll(&capture);
+  uint16_t idle = evt.idleMs();
+  t->verify(idle > 0 && idle <= 11, F("Should wait out the debounce delay"));
+
+  start = EventuinoHal::millis();
+  evt.waitForEvents();
+  evt.poll(&capture);
+  unsigned long waited = EventuinoHal::millis() - start;
+  t->verify(waited >= 10 && waited < 50, F("Should have slept through the debounce delay"));
+  t->verify(capture.callCount == 1, F("onPressed should have been called"));
+  t->verify(capture.value == 4, F("Expected value = 4"));
+}
+
+void testWaitForTimer(TestInvocation* t) {
+  t->setName(F("waitForEvents wakes for a timer deadline"));
+  Timer14Bit tmr(9);
+  CallbackCapture capture;
+  tmr.onExpire = [](uint8_t value, void* state) {
+    CallbackCapture* c = static_cast<CallbackCapture*>(state);
+    c->value = value;
+    c->callCount++;
+  };
+  Eventuino evt;
+  evt.addEventSource(&tmr);
+  tmr.start(30);
+
+  unsigned long start = EventuinoHal::millis();
+  while (capture.callCount == 0 && EventuinoHal::millis() - start < 200) {
+    evt.waitForEvents();
+    evt.poll(&capture);
+  }
+  unsigned long waited = EventuinoHal::millis() - start;
+  t->verify(capture.callCount == 1, F("onExpire should have been called"));
+  t->verify(waited >= 30 && waited < 60, F("Should have slept until the deadline"));
+}
+
+uint8_t virtualPins[4] = { 1, 1, 1, 1 };
+
+void virtualPinSetup(uint8_t) {}
+
+uint8_t virtualPinRead(uint8_t pinNumber) {
+  return virtualPins[pinNumber];
+}
+
+std::atomic<unsigned long> fastHandledAt(0);
+std::atomic<uint8_t> slowHandled(0);
+
+void testThreadedIsolation(TestInvocation* t) {
+  t->setName(F("ThreadedEventuino isolates slow callbacks"));
+  Button slow(0, 0, virtualPinSetup, virtualPinRead);
+  Button fast(1, 1, virtualPinSetup, virtualPinRead);
+  slow.onPressed = [](uint8_t, void*) {
+    usleep(200000);
+    slowHandled++;
+  };
+  fast.onPressed = [](uint8_t, void*) {
+    fastHandledAt.store(EventuinoHal::millis());
+  };
+  ThreadedEventuino evt(2);
+  evt.addEventSource(&slow);
+  evt.addEventSource(&fast);
+  evt.begin();
+  evt.start();
+
+  unsigned long pressedAt = EventuinoHal::millis();
+  virtualPins[0] = EventuinoHal::LOW_STATE;
+  virtualPins[1] = EventuinoHal::LOW_STATE;
+  while (fastHandledAt.load() == 0 && EventuinoHal::millis() - pressedAt < 500) {
+    usleep(1000);
+  }
+  t->verify(fastHandledAt.load() != 0, F("Fast callback should have run"));
+  t->verify(fastHandledAt.load() - pressedAt < 100, F("Fast callback waited on slow one"));
+  evt.stop();
+  t->verify(slowHandled.load() == 1, F("stop() should let pending callbacks finish"));
+  virtualPins[0] = EventuinoHal::HIGH_STATE;
+  virtualPins[1] = EventuinoHal::HIGH_STATE;
+}
+
+// Emits a burst of events on every poll, up to a limit
+class BurstSource: public EventSource {
+
+  public:
+    BurstSource(uint8_t value, eventuinoCallback_t callback): 
+        _value(value), _callback(callback) {};
+    void setup() override {};
+    void poll(void* state = nullptr) override {
+      for (uint8_t i = 0; i < 20 && emitted < 200; i++, emitted++) {
+        emit(_callback, _value, KIND_CHANGE, state);
+      }
+    };
+    uint16_t emitted = 0;
+
+  private:
+    uint8_t _value;
+    eventuinoCallback_t _callback;
+
+};
+
+struct OrderingCapture {
+  std::atomic<bool> inFlight[4];
+  std::atomic<uint16_t> handled[4];
+  std::atomic<bool> overlapped;
+};
+
+void testThreadedOrdering(TestInvocation* t) {
+  t->setName(F("ThreadedEventuino serializes each source"));
+  static OrderingCapture capture;
+  for (uint8_t i = 0; i < 4; i++) {
+    capture.inFlight[i] = false;
+    capture.handled[i] = 0;
+  }
+  capture.overlapped = false;
+  auto onBurst = [](uint8_t value, void* state) {
+    OrderingCapture* c = static_cast<OrderingCapture*>(state);
+    if (c->inFlight[value].exchange(true)) c->overlapped = true;
+    usleep(50);
+    c->handled[value]++;
+    c->inFlight[value] = false;
+  };
+  BurstSource sources[4] = {
+    BurstSource(0, onBurst), BurstSource(1, onBurst),
+    BurstSource(2, onBurst), BurstSource(3, onBurst)
+  };
+  ThreadedEventuino evt(3, 1024);
+  for (uint8_t i = 0; i < 4; i++) evt.addEventSource(&sources[i]);
+  evt.begin();
+  evt.start(&capture);
+  usleep(100000);
+  evt.stop();
+
+  t->verify(!capture.overlapped, F("A source's callbacks overlapped"));
+  t->verify(evt.droppedEvents() == 0, F("No events should have been dropped"));
+  for (uint8_t i = 0; i < 4; i++) {
+    t->verify(capture.handled[i] == 200, F("Every event should have been handled"));
+  }
+}
+
+void testThreadedSinkScope(TestInvocation* t) {
+  t->setName(F("ThreadedEventuino only captures its own events"));
+  static std::atomic<uint16_t> handledOnMain;
+  static std::thread::id mainThread;
+  handledOnMain = 0;
+  mainThread = std::this_thread::get_id();
+  auto onBurst = [](uint8_t, void*) {
+    if (std::this_thread::get_id() == mainThread) handledOnMain++;
+  };
+  BurstSource source(0, onBurst);
+  EventQueue queue(64, 5);
+  Eventuino evt;
+  evt.addEventSource(&source);
+  evt.setEventQueue(&queue);
+  ThreadedEventuino threaded(1);
+  threaded.begin();
+  threaded.start();
+
+  evt.poll();
+  t->verify(handledOnMain == 5 && queue.size() == 15,
+      F("Another instance's events should go to its own queue"));
+  threaded.stop();
+  evt.poll();
+  t->verify(handledOnMain == 10 && queue.size() == 30,
+      F("stop() should leave another instance's queue installed"));
+}
+
+#define DIFF_INPUTS 200
+#define DIFF_STEPS 1500
+
+uint8_t diffLevels[DIFF_INPUTS];
+unsigned long virtualMillis = 0;
+
+uint8_t diffPinRead(uint8_t pinNumber) {
+  return diffLevels[pinNumber];
+}
+
+unsigned long virtualClock() {
+  return virtualMillis;
+}
+
+// Events of one poll, encoded as (index << 2) | kind
+enum { DIFF_PRESS = 0, DIFF_RELEASE, DIFF_LONG_HOLD };
+typedef std::vector<uint32_t> DiffLog;
+
+void testBitSlicedDebouncer(TestInvocation* t) {
+  t->setName(F("BitSlicedDebouncer matches DigitalPinSource"));
+  std::vector<Button> buttons;
+  buttons.reserve(DIFF_INPUTS);
+  for (uint8_t i = 0; i < DIFF_INPUTS; i++) {
+    diffLevels[i] = EventuinoHal::HIGH_STATE;
+    buttons.emplace_back(i, i, virtualPinSetup, diffPinRead);
+    buttons[i].onPressed = [](uint8_t value, void* state) {
+      static_cast<DiffLog*>(state)->push_back(value << 2 | DIFF_PRESS);
+    };
+    buttons[i].onReleased = [](uint8_t value, void* state) {
+      static_cast<DiffLog*>(state)->push_back(value << 2 | DIFF_RELEASE);
+    };
+    buttons[i].onLongPress = [](uint8_t value, void* state) {
+      static_cast<DiffLog*>(state)->push_back(value << 2 | DIFF_LONG_HOLD);
+    };
+    buttons[i].enableRepeat(i % 2 == 0);
+  }
+
+  // One engine per kernel, all fed the same inputs
+  BitSlicedDebouncer scalar(DIFF_INPUTS, 10, 50, 10);
+  BitSlicedDebouncer sse2(DIFF_INPUTS, 10, 50, 10);
+  BitSlicedDebouncer avx2(DIFF_INPUTS, 10, 50, 10);
+  BitSlicedDebouncer* engines[3];
+  uint8_t engineCount = 0;
+  if (scalar.setKernel(BitSlicedDebouncer::KERNEL_SCALAR)) engines[engineCount++] = &scalar;
+  if (sse2.setKernel(BitSlicedDebouncer::KERNEL_SSE2)) engines[engineCount++] = &sse2;
+  if (avx2.setKernel(BitSlicedDebouncer::KERNEL_AVX2)) engines[engineCount++] = &avx2;
+  for (uint8_t e = 0; e < engineCount; e++) {
+    engines[e]->onChange = [](uint32_t index, bool isActive, void* state) {
+      static_cast<DiffLog*>(state)->push_back(index << 2 | (isActive ? DIFF_PRESS : DIFF_RELEASE));
+    };
+    engines[e]->onLongHold = [](uint32_t index, void* state) {
+      static_cast<DiffLog*>(state)->push_back(index << 2 | DIFF_LONG_HOLD);
+    };
+    for (uint8_t i = 0; i < DIFF_INPUTS; i += 2) engines[e]->enableRepeat(i, true);
+  }
+
+  // Inputs toggle at different rates: some bounce constantly, some are
+  // held long enough for long holds and repeats. Starting near the end
+  // of the 16-bit range covers the timestamp wraparound too.
+  static const uint16_t flipOdds[4] = { 300, 6, 40, 15 };
+  uint32_t seed = 12345;
+  uint32_t eventCount = 0;
+  uint32_t longHoldCount = 0;
+  bool matched = true;
+  virtualMillis = 0xFFFF - DIFF_STEPS / 2;
+  EventuinoHal::setClockSource(virtualClock);
+  for (uint16_t step = 0; step < DIFF_STEPS && matched; step++) {
+    virtualMillis++;
+    for (uint8_t i = 0; i < DIFF_INPUTS; i++) {
+      seed = seed * 1103515245 + 12345;
+      if ((seed >> 16) % flipOdds[i % 4] == 0) {
+        diffLevels[i] = !diffLevels[i];
+      }
+    }
+    DiffLog expected;
+    for (uint8_t i = 0; i < DIFF_INPUTS; i++) buttons[i].poll(&expected);
+    for (uint8_t e = 0; e < engineCount; e++) {
+      for (uint8_t i = 0; i < DIFF_INPUTS; i++) engines[e]->setInput(i, diffLevels[i]);
+      DiffLog actual;
+      engines[e]->poll(&actual);
+      if (actual != expected) matched = false;
+    }
+    eventCount += expected.size();
+    for (uint32_t event : expected) {
+      if ((event & 3) == DIFF_LONG_HOLD) longHoldCount++;
+    }
+  }
+  EventuinoHal::setClockSource(nullptr);
+
+  t->verify(matched, F("Engine events differ from DigitalPinSource"));
+  t->verify(eventCount > 500, F("Too few events to be a meaningful comparison"));
+  t->verify(longHoldCount > 20, F("Too few long holds to be a meaningful comparison"));
+}
+
+void testBitSlicedDebouncerPadding(TestInvocation* t) {
+  t->setName(F("BitSlicedDebouncer ignores bits past inputCount"));
+  BitSlicedDebouncer engine(70, 10, 50, 10);
+  static uint32_t changes;
+  changes = 0;
+  engine.onChange = [](uint32_t, bool, void*) { changes++; };
+  engine.inputWords()[1] = 0;  // inputs 64-69 and the padding LOW
+  unsigned long start = EventuinoHal::millis();
+  engine.pollAt(start);
+  engine.pollAt(start + 20);
+  t->verify(changes == 6, F("Only the 6 real inputs should change"));
+  t->verify(engine.isActive(69), F("Input 69 should be active"));
+  t->verify(!engine.isActive(70), F("Input 70 does not exist"));
+}
+
+void testSerialStream(TestInvocation* t) {
+  t->setName(F("SerialLineSource reads the HAL's serial fd"));
+  int serialPipe[2];
+  t->verify(pipe(serialPipe) == 0, F("pipe failed"));
+  EventuinoHal::attachSerialSource(serialPipe[0]);
+  static std::vector<std::string> lines;
+  lines.clear();
+  SerialLineSource source(32, 1);
+  source.onFrame = [](uint8_t, const uint8_t* frame, uint8_t, void*) {
+    lines.push_back((const char*)frame);
+  };
+
+  source.poll();
+  t->verify(lines.empty(), F("Nothing written yet"));
+  const char* input = "led on\nbright";
+  if (write(serialPipe[1], input, strlen(input)) < 0) perror("write serial");
+  source.poll();
+  t->verify(lines.size() == 1 && lines[0] == "led on", F("First line not read"));
+  input = "ness 40\r\n";
+  if (write(serialPipe[1], input, strlen(input)) < 0) perror("write serial");
+  source.poll();
+  t->verify(lines.size() == 2 && lines[1] == "brightness 40", F("Split line not joined"));
+
+  EventuinoHal::attachSerialSource(-1);
+  close(serialPipe[0]);
+  close(serialPipe[1]);
+}
+
+struct SpanCapture {
+  uint32_t count = 0;
+  uint32_t span = 0;
+  uint8_t callCount = 0;
+};
+
+void testPulseCounterIdle(TestInvocation* t) {
+  t->setName(F("PulseCounter spans an idle signal, up to the timestamps' range"));
+  EventuinoHal::setClockSource(virtualClock);
+  virtualMillis = 1000;
+  PulseCounter meter(1000, 1);
+  meter.onCount = [](uint8_t, uint32_t count, uint32_t spanMicros, void* state) {
+    SpanCapture* c = static_cast<SpanCapture*>(state);
+    c->count = count;
+    c->span = spanMicros;
+    c->callCount++;
+  };
+  SpanCapture capture;
+  meter.setup();
+  meter.edgeFromIsr(1500000);
+  virtualMillis = 2000;
+  meter.poll(&capture);
+
+  // Polled through 10 minutes idle, then 1000 edges
+  for (int i = 0; i < 600; i++) {
+    virtualMillis += 1000;
+    meter.poll(&capture);
+  }
+  uint32_t edge = 1500000;
+  for (int i = 0; i < 1000; i++) meter.edgeFromIsr(edge += 600000);
+  virtualMillis += 1000;
+  meter.poll(&capture);
+  t->verify(capture.callCount == 2 && capture.count == 1000 && capture.span == 600000000,
+      F("Span should cover the idle time"));
+  t->verify(PulseCounter::frequencyMilliHz(capture.count, capture.span) == 1666,
+      F("Frequency should average over the idle time"));
+
+  // Idle for longer than the microsecond timestamps can span
+  for (int i = 0; i < 4500; i++) {
+    virtualMillis += 1000;
+    meter.poll(&capture);
+  }
+  meter.edgeFromIsr(edge + 4500000000u);
+  virtualMillis += 1000;
+  meter.poll(&capture);
+  t->verify(capture.callCount == 3 && capture.count == 1 && capture.span == 0,
+      F("A span the timestamps can't measure should be unknown"));
+  EventuinoHal::setClockSource(nullptr);
+}
+
+int main() {
+  TestFunction tests[] = {
+    testEdgeEvents,
+    testWaitForEdge,
+    testWaitForTimer,
+    testThreadedIsolation,
+    testThreadedOrdering,
+    testThreadedSinkScope,
+    testBitSlicedDebouncer,
+    testBitSlicedDebouncerPadding,
+    testSerialStream,
+    testPulseCounterIdle
+  };
+
+  runTestSuite(tests, before, after);
+  return 0;
+}
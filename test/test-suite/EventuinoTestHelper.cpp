@@ -43,6 +43,11 @@ Button EventuinoTestHelper::buttonSrc(uint8_t pinNumber, uint8_t value) {
   return b;
 }
 
+BasicButton<5, 30, 8> EventuinoTestHelper::basicButtonSrc(uint8_t pinNumber, uint8_t value) {
+  BasicButton<5, 30, 8> b(pinNumber, value, EventuinoTestHelper::helperPinSetup, EventuinoTestHelper::helperDigitalRead);
+  return b;
+}
+
 Toggle EventuinoTestHelper::toggleSrc(uint8_t pinNumber, uint8_t value) {
   Toggle t(pinNumber, value, EventuinoTestHelper::helperPinSetup, EventuinoTestHelper::helperDigitalRead);
   return t;
@@ -95,3 +100,48 @@ void EventuinoTestHelper::doBouncyDeactivate(DigitalPinSource* dps, void* state
   _evt.poll(state);
   clearEventSource();
 }
+
+PinSnapshot EventuinoTestHelper::getPinState(DigitalPinSource* dps) {
+  return { dps->_state, dps->_toggleTime, dps->_lastRepeat };
+}
+
+void EventuinoTestHelper::setPinState(DigitalPinSource* dps, PinSnapshot snapshot) {
+  dps->_state = snapshot.state;
+  dps->_toggleTime = snapshot.toggleTime;
+  dps->_lastRepeat = snapshot.lastRepeat;
+}
+
+uint8_t EventuinoTestHelper::referencePoll(PinSnapshot& pin, uint8_t reading, uint16_t now,
+    uint8_t debounceDelayMs, uint16_t longHoldDelayMs, uint8_t repeatMs) {
+  if (reading != bitRead(pin.state, 0)) {
+    pin.toggleTime = now;
+    bitWrite(pin.state, 0, reading);
+  }
+  if ((uint16_t)(now - pin.toggleTime) <= debounceDelayMs) return 0;
+
+  uint8_t prevState = bitRead(pin.state, 1);
+  bitWrite(pin.state, 1, reading);
+  if (reading != prevState) {
+    if (reading == LOW && prevState == HIGH) {
+      pin.lastRepeat = now;
+      bitWrite(pin.state, 3, 1);
+    } else {
+      pin.toggleTime = 0;
+      pin.lastRepeat = 0;
+      bitWrite(pin.state, 3, 0);
+      bitWrite(pin.state, 2, 0);
+    }
+    return 1;
+  }
+  if (reading == LOW &&
+      ((uint16_t)(now - pin.toggleTime) > longHoldDelayMs) &&
+      ((uint16_t)(now - pin.lastRepeat) > repeatMs)) {
+    bool isInitialLongHold = !bitRead(pin.state, 2);
+    bitWrite(pin.state, 2, 1);
+    if (isInitialLongHold || bitRead(pin.state, 4)) {
+      pin.lastRepeat = now;
+      return 2;
+    }
+  }
+  return 0;
+}
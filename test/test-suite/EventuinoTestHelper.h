@@ -4,12 +4,29 @@
 
 #include <Eventuino.h>
 #include "eventuino/DigitalPinSource.h"
+#include "eventuino/DigitalPinGroup.h"
+#include "eventuino/BlockSampler.h"
 #include "eventuino/Button.h"
+#include "eventuino/GestureRecognizer.h"
+#include "eventuino/MuxScanner.h"
+#include "eventuino/Output.h"
+#include "eventuino/PositionSelector.h"
+#include "eventuino/PulseCounter.h"
+#include "eventuino/PulseTimer.h"
+#include "eventuino/SerialLineSource.h"
+#include "eventuino/Task.h"
 #include "eventuino/Toggle.h"
 #include "eventuino/Timer.h"
 
 namespace eventuino {
 
+  // A DigitalPinSource's debounce state, for the exhaustive transition test
+  struct PinSnapshot {
+    uint8_t state;
+    uint16_t toggleTime;
+    uint16_t lastRepeat;
+  };
+
   class EventuinoTestHelper {
 
     public:
@@ -24,10 +41,22 @@ namespace eventuino {
       void doBouncyDeactivate(DigitalPinSource* dps, void* state = nullptr);
       DigitalPinSource digitalPinSrc(uint8_t pinNumber, uint8_t value);
       Button buttonSrc(uint8_t pinNumber, uint8_t value);
+      BasicButton<5, 30, 8> basicButtonSrc(uint8_t pinNumber, uint8_t value);
       Toggle toggleSrc(uint8_t pinNumber, uint8_t value);
       Timer14Bit timerSrc(uint8_t value);
       IntervalTimer14Bit intervalTimerSrc(uint8_t value);
 
+      PinSnapshot getPinState(DigitalPinSource* dps);
+      void setPinState(DigitalPinSource* dps, PinSnapshot snapshot);
+
+      /*
+       * The DEBOUNCE_STABLE logic of DigitalPinSource::poll() as it was
+       * before the transition table, as a reference. Updates the snapshot
+       * and returns 1 for a change event, 2 for a long hold.
+       */
+      static uint8_t referencePoll(PinSnapshot& pin, uint8_t reading, uint16_t now,
+          uint8_t debounceDelayMs, uint16_t longHoldDelayMs, uint8_t repeatMs);
+
     private:
       EventuinoTestHelper(EventuinoTestHelper &t) = delete;
       void setEventSource(EventSource* es);